@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AILODSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EnemyBehaviorTreeComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "EnemyMovementComponent.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI LOD"), STAT_AILOD, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Agents"), STAT_AILODAgents, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI LOD Bucket Changes"), STAT_AILODBucketChanges, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld AILODReportCommand(
+	TEXT("Shooter.AILOD.Report"),
+	TEXT("Logs the number of enemies in each AI level-of-detail bucket"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UAILODSubsystem* AILOD = World ? World->GetSubsystem<UAILODSubsystem>() : nullptr)
+		{
+			AILOD->LogReport();
+		}
+	}));
+
+UAILODSubsystem::UAILODSubsystem() :
+	AgentsPerTick(16),
+	PromotionHoldTime(5.f),
+	NotRenderedBucketPenalty(1),
+	NextAgentIndex(0)
+{
+
+}
+
+void UAILODSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AILOD);
+
+	UWorld* World{ GetWorld() };
+	FPlayerLocations PlayerLocations;
+	GetPlayerLocations(PlayerLocations);
+	const float CurrentTime{ World->GetTimeSeconds() };
+
+	// Time-sliced: a few agents per frame, round robin
+	const int32 NumToUpdate{ FMath::Min(AgentsPerTick, Agents.Num()) };
+	for (int32 Count = 0; Count < NumToUpdate && Agents.Num() > 0; ++Count)
+	{
+		if (NextAgentIndex >= Agents.Num())
+		{
+			NextAgentIndex = 0;
+		}
+		UpdateAgent(NextAgentIndex++, PlayerLocations, CurrentTime);
+	}
+
+	SET_DWORD_STAT(STAT_AILODAgents, Agents.Num());
+}
+
+bool UAILODSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && Buckets.Num() > 0;
+}
+
+TStatId UAILODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAILODSubsystem, STATGROUP_Tickables);
+}
+
+void UAILODSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	const int32 AgentIndex{ Agents.Add(Enemy) };
+	if (AgentIndex == INDEX_NONE) return;
+
+	// Full rate until the first evaluation
+	if (Buckets.Num() > 0)
+	{
+		SetAgentBucket(Agents[AgentIndex], 0);
+	}
+}
+
+void UAILODSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	Agents.Remove(Enemy);
+}
+
+void UAILODSubsystem::PromoteEnemy(AEnemy* Enemy)
+{
+	FAILODAgent* Agent{ Agents.Find(Enemy) };
+	if (Agent == nullptr || Buckets.Num() == 0) return;
+
+	Agent->PromotedUntil = GetWorld()->GetTimeSeconds() + PromotionHoldTime;
+	SetAgentBucket(*Agent, 0);
+}
+
+int32 UAILODSubsystem::GetEnemyBucket(const AEnemy* Enemy) const
+{
+	const FAILODAgent* Agent{ Agents.Find(Enemy) };
+	return Agent ? Agent->Bucket : INDEX_NONE;
+}
+
+void UAILODSubsystem::LogReport() const
+{
+	TArray<int32, TInlineAllocator<8>> BucketCounts;
+	BucketCounts.SetNumZeroed(Buckets.Num());
+	for (const FAILODAgent& Agent : Agents)
+	{
+		if (BucketCounts.IsValidIndex(Agent.Bucket))
+		{
+			BucketCounts[Agent.Bucket]++;
+		}
+	}
+
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); ++BucketIndex)
+	{
+		const FAILODBucket& Bucket{ Buckets[BucketIndex] };
+		UE_LOG(LogTemp, Log, TEXT("Bucket %d (up to %.0f): %d enemies, behavior tree %.2fs, perception %.2fs, movement %.3fs"),
+			BucketIndex,
+			Bucket.MaxDistance,
+			BucketCounts[BucketIndex],
+			Bucket.BehaviorTreeInterval,
+			Bucket.PerceptionInterval,
+			Bucket.MovementTickInterval);
+	}
+}
+
+void UAILODSubsystem::UpdateAgent(int32 AgentIndex, TArrayView<const FVector> PlayerLocations, float CurrentTime)
+{
+	FAILODAgent& Agent{ Agents[AgentIndex] };
+	const AEnemy* Enemy{ Agent.Enemy.Get() };
+	if (Enemy == nullptr) return;
+
+	// Aggro and damage keep the top bucket for a while
+	if (CurrentTime < Agent.PromotedUntil) return;
+
+	float NearestDistSquared{ 0.f };
+	if (PlayerLocations.Num() > 0)
+	{
+		NearestDistSquared = TNumericLimits<float>::Max();
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(PlayerLocation, Enemy->GetActorLocation()));
+		}
+	}
+
+	SetAgentBucket(Agent, FindBucket(NearestDistSquared, Enemy->WasRecentlyRendered(0.2f)));
+}
+
+int32 UAILODSubsystem::FindBucket(float DistSquared, bool bRecentlyRendered) const
+{
+	int32 Bucket{ Buckets.Num() - 1 };
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num() - 1; ++BucketIndex)
+	{
+		if (DistSquared <= FMath::Square(Buckets[BucketIndex].MaxDistance))
+		{
+			Bucket = BucketIndex;
+			break;
+		}
+	}
+
+	if (!bRecentlyRendered)
+	{
+		Bucket = FMath::Min(Bucket + NotRenderedBucketPenalty, Buckets.Num() - 1);
+	}
+	return Bucket;
+}
+
+void UAILODSubsystem::SetAgentBucket(FAILODAgent& Agent, int32 Bucket)
+{
+	if (Agent.Bucket == Bucket) return;
+
+	AEnemy* Enemy{ Agent.Enemy.Get() };
+	if (Enemy == nullptr) return;
+
+	Agent.Bucket = Bucket;
+	ApplyBucket(Enemy, Buckets[Bucket]);
+	INC_DWORD_STAT(STAT_AILODBucketChanges);
+}
+
+void UAILODSubsystem::ApplyBucket(AEnemy* Enemy, const FAILODBucket& Bucket) const
+{
+	if (AEnemyController* EnemyController = Enemy->GetEnemyController())
+	{
+		// The tree reschedules its own tick interval, so the bucket only sets a floor under it
+		if (UEnemyBehaviorTreeComponent* BehaviorTree = EnemyController->GetBehaviorTreeComponent())
+		{
+			BehaviorTree->SetMinTickInterval(Bucket.BehaviorTreeInterval);
+		}
+	}
+
+	Enemy->SetPerceptionInterval(Bucket.PerceptionInterval);
+	Enemy->SetDecisionInterval(Bucket.BehaviorTreeInterval);
+
+	if (UCharacterMovementComponent* Movement = Enemy->GetCharacterMovement())
+	{
+		Movement->SetComponentTickInterval(Bucket.MovementTickInterval);
+	}
+
+	if (UEnemyMovementComponent* EnemyMovement = Cast<UEnemyMovementComponent>(Enemy->GetCharacterMovement()))
+	{
+		EnemyMovement->SetMovementLOD(Bucket.bSimplifiedMovement ? EEnemyMovementLOD::EEML_Simplified : EEnemyMovementLOD::EEML_Full);
+	}
+}
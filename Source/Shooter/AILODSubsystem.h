@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAgentSubsystem.h"
+#include "Tickable.h"
+#include "AILODSubsystem.generated.h"
+
+class AEnemy;
+
+/** Update rates for the enemies in one AI level-of-detail bucket */
+USTRUCT()
+struct FAILODBucket
+{
+	GENERATED_BODY()
+
+	/** Enemies up to this distance from the nearest player use this bucket; the last bucket takes everyone further away */
+	UPROPERTY(Config)
+	float MaxDistance = 0.f;
+
+	/** Seconds between behavior tree ticks or native decisions; 0 ticks every frame */
+	UPROPERTY(Config)
+	float BehaviorTreeInterval = 0.f;
+
+	/** Seconds between aggro and attack range checks; 0 checks on every perception pass */
+	UPROPERTY(Config)
+	float PerceptionInterval = 0.f;
+
+	/** Seconds between character movement ticks; 0 ticks every frame */
+	UPROPERTY(Config)
+	float MovementTickInterval = 0.f;
+
+	/** Nav walk along the navmesh instead of full walking */
+	UPROPERTY(Config)
+	bool bSimplifiedMovement = false;
+};
+
+/** An enemy tracked by the AI level-of-detail subsystem */
+struct FAILODAgent
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+
+	/** Index into Buckets, or INDEX_NONE before the first evaluation */
+	int32 Bucket = INDEX_NONE;
+
+	/** World time until which the enemy stays in the top bucket after aggro or damage */
+	float PromotedUntil = 0.f;
+};
+
+/**
+ * Groups enemies into update-rate buckets by distance to the nearest player and
+ * whether they were recently rendered. Each bucket sets the behavior tree,
+ * perception and movement tick intervals and the movement level of detail. A
+ * few enemies are re-bucketed each frame; aggro and damage promote an enemy to
+ * the top bucket right away.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UAILODSubsystem : public UEnemyAgentSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UAILODSubsystem();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called from AEnemy::BeginPlay; the enemy starts in the top bucket */
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Called from AEnemy::EndPlay */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Moves Enemy to the top bucket and keeps it there for PromotionHoldTime */
+	void PromoteEnemy(AEnemy* Enemy);
+
+	/** Bucket index of Enemy; 0 is the top bucket, INDEX_NONE if not registered */
+	int32 GetEnemyBucket(const AEnemy* Enemy) const;
+
+	/** Logs the number of enemies in each bucket */
+	void LogReport() const;
+
+private:
+	/** Recomputes the bucket of the agent at AgentIndex and applies it if it changed */
+	void UpdateAgent(int32 AgentIndex, TArrayView<const FVector> PlayerLocations, float CurrentTime);
+
+	/** Bucket for an enemy at DistSquared from the nearest player */
+	int32 FindBucket(float DistSquared, bool bRecentlyRendered) const;
+
+	void SetAgentBucket(FAILODAgent& Agent, int32 Bucket);
+
+	/** Sets the behavior tree, perception and movement intervals and movement LOD of Enemy from Bucket */
+	void ApplyBucket(AEnemy* Enemy, const FAILODBucket& Bucket) const;
+
+	/** Nearest first; the last bucket takes every enemy further away */
+	UPROPERTY(Config)
+	TArray<FAILODBucket> Buckets;
+
+	/** Enemies re-bucketed per frame */
+	UPROPERTY(Config)
+	int32 AgentsPerTick;
+
+	/** Seconds an enemy stays in the top bucket after aggro or damage */
+	UPROPERTY(Config)
+	float PromotionHoldTime;
+
+	/** Buckets an enemy drops when it was not rendered recently */
+	UPROPERTY(Config)
+	int32 NotRenderedBucketPenalty;
+
+	TEnemyAgentRegistry<FAILODAgent> Agents;
+
+	/** Next agent to re-bucket */
+	int32 NextAgentIndex;
+};
@@ -23,8 +23,11 @@ protected:
 
 	virtual void BeginPlay() override;
 
-	/** Override of SetItemProperties so we can set AmmoMesh properties */
-	virtual void SetItemProperties(EItemState State) override;
+	/** Also re-enables the AmmoCollisionSphere turned off on pickup */
+	virtual void ResetItem() override;
+
+	/** Override of ApplyStateCollision so we can set AmmoMesh properties */
+	virtual void ApplyStateCollision(const FItemStateCollision& StateCollision) override;
 
 	UFUNCTION()
 	void AmmoSphereOverlap(
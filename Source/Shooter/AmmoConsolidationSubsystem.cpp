@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AmmoConsolidationSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Components/WidgetComponent.h"
+#include "Ammo.h"
+#include "ItemPoolSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ammo Consolidation"), STAT_AmmoConsolidation, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ammo Pickups Merged"), STAT_AmmoPickupsMerged, STATGROUP_Shooter);
+
+UAmmoConsolidationSubsystem::UAmmoConsolidationSubsystem() :
+	ConsolidationInterval(2.f),
+	MergeRadius(150.f),
+	PlayerExclusionRadius(600.f),
+	MaxMergesPerPass(16),
+	TimeSinceLastPass(0.f)
+{
+
+}
+
+bool UAmmoConsolidationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Only game worlds have pickups to merge
+	const UWorld* World{ Cast<UWorld>(Outer) };
+	return World && World->IsGameWorld();
+}
+
+void UAmmoConsolidationSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceLastPass += DeltaTime;
+	if (TimeSinceLastPass >= ConsolidationInterval)
+	{
+		TimeSinceLastPass = 0.f;
+		ConsolidateAmmo();
+	}
+}
+
+bool UAmmoConsolidationSubsystem::IsTickable() const
+{
+	// The class default object is never ticked
+	return !IsTemplate() && GetWorld() != nullptr;
+}
+
+TStatId UAmmoConsolidationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAmmoConsolidationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UAmmoConsolidationSubsystem::ConsolidateAmmo()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AmmoConsolidation);
+
+	UWorld* World{ GetWorld() };
+	UItemPoolSubsystem* ItemPool{ World->GetSubsystem<UItemPoolSubsystem>() };
+	if (ItemPool == nullptr) return 0;
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+	const float PlayerExclusionRadiusSquared{ PlayerExclusionRadius * PlayerExclusionRadius };
+
+	// Grid of the ammo pickups lying in the world, away from players
+	AmmoGrid.SetCellSize(MergeRadius);
+	AmmoGrid.Reset();
+	for (AItem* Item : ItemPool->GetActiveItems())
+	{
+		AAmmo* Ammo{ Cast<AAmmo>(Item) };
+		if (Ammo == nullptr ||
+			Ammo->GetItemState() != EItemState::EIS_Pickup ||
+			Ammo->IsHidden() ||
+			Ammo->GetPickupWidget()->IsVisible())
+		{
+			// Falling, being picked up, or being looked at
+			continue;
+		}
+
+		const FVector Location{ Ammo->GetActorLocation() };
+		const bool bNearPlayer{ PlayerLocations.ContainsByPredicate([&](const FVector& PlayerLocation)
+		{
+			return FVector::DistSquared(PlayerLocation, Location) < PlayerExclusionRadiusSquared;
+		}) };
+		if (!bNearPlayer)
+		{
+			AmmoGrid.Add(Location, Ammo);
+		}
+	}
+
+	Merged.Reset();
+	Merged.SetNumZeroed(AmmoGrid.Num());
+
+	int32 NumMerged{ 0 };
+	TArray<AAmmo*, TInlineAllocator<16>> ToRelease;
+	for (int32 Index = 0; Index < AmmoGrid.Num() && NumMerged < MaxMergesPerPass; ++Index)
+	{
+		if (Merged[Index]) continue;
+
+		AAmmo* Survivor{ AmmoGrid.GetElement(Index) };
+		int32 ItemCount{ Survivor->GetItemCount() };
+		AmmoGrid.ForEachInRadius(AmmoGrid.GetLocation(Index), MergeRadius, [&](int32 OtherIndex, AAmmo* Other, float)
+		{
+			if (OtherIndex == Index ||
+				Merged[OtherIndex] ||
+				NumMerged >= MaxMergesPerPass ||
+				Other->GetAmmoType() != Survivor->GetAmmoType())
+			{
+				return;
+			}
+
+			ItemCount += Other->GetItemCount();
+			Merged[OtherIndex] = true;
+			ToRelease.Add(Other);
+			NumMerged++;
+		});
+		Survivor->SetItemCount(ItemCount);
+	}
+
+	for (AAmmo* Ammo : ToRelease)
+	{
+		ItemPool->ReleaseItem(Ammo);
+	}
+
+	INC_DWORD_STAT_BY(STAT_AmmoPickupsMerged, NumMerged);
+	return NumMerged;
+}
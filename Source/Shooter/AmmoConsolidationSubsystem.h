@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashGrid.h"
+#include "AmmoConsolidationSubsystem.generated.h"
+
+class AAmmo;
+
+/**
+ * Periodically folds the ItemCount of ammo pickups lying close together into a
+ * single AAmmo and returns the others to the item pool, so ammo left around
+ * during a long session does not keep adding actors
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UAmmoConsolidationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UAmmoConsolidationSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Runs one consolidation pass. Returns the number of pickups merged away */
+	int32 ConsolidateAmmo();
+
+private:
+	/** Seconds between consolidation passes */
+	UPROPERTY(Config)
+	float ConsolidationInterval;
+
+	/** Pickups of the same ammo type closer than this are merged */
+	UPROPERTY(Config)
+	float MergeRadius;
+
+	/** Pickups closer than this to a player are left alone so merges are not seen */
+	UPROPERTY(Config)
+	float PlayerExclusionRadius;
+
+	/** Most pickups released in one pass; the rest wait for the next pass */
+	UPROPERTY(Config)
+	int32 MaxMergesPerPass;
+
+	float TimeSinceLastPass;
+
+	/** Reused between passes */
+	TSpatialHashGrid<AAmmo*> AmmoGrid;
+	TArray<bool> Merged;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AttackTokenComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Attack Token Grants"), STAT_AttackTokenGrants, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Attack Token Denials"), STAT_AttackTokenDenials, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld AttackTokenReportCommand(
+	TEXT("Shooter.AttackTokens.Report"),
+	TEXT("Logs the attack tokens held on each player"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APawn* Pawn{ It->Get() ? It->Get()->GetPawn() : nullptr };
+			if (const UAttackTokenComponent* AttackTokens = Pawn ? Pawn->FindComponentByClass<UAttackTokenComponent>() : nullptr)
+			{
+				AttackTokens->LogReport();
+			}
+		}
+	}));
+
+UAttackTokenComponent::UAttackTokenComponent() :
+	MaxTokens(2),
+	TokenCooldown(0.5f),
+	AttackerCooldown(1.5f),
+	MaxHoldTime(3.f),
+	Grants(0),
+	Denials(0)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UAttackTokenComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Tokens.SetNum(FMath::Max(MaxTokens, 1));
+}
+
+bool UAttackTokenComponent::RequestToken(AActor* Attacker)
+{
+	if (Attacker == nullptr) return false;
+
+	const float CurrentTime{ GetWorld()->GetTimeSeconds() };
+	ExpireTokens(CurrentTime);
+
+	FAttackToken* FreeToken{ nullptr };
+	for (FAttackToken& Token : Tokens)
+	{
+		if (Token.Holder == Attacker) return true;
+
+		if (FreeToken == nullptr && !Token.Holder.IsValid() && CurrentTime >= Token.AvailableTime)
+		{
+			FreeToken = &Token;
+		}
+	}
+
+	// Recent attackers wait so the tokens rotate
+	AttackerCooldowns.RemoveAllSwap([CurrentTime](const TPair<TWeakObjectPtr<AActor>, float>& Cooldown)
+	{
+		return !Cooldown.Key.IsValid() || CurrentTime >= Cooldown.Value;
+	});
+	const bool bCoolingDown{ AttackerCooldowns.ContainsByPredicate([Attacker](const TPair<TWeakObjectPtr<AActor>, float>& Cooldown)
+	{
+		return Cooldown.Key == Attacker;
+	}) };
+
+	if (FreeToken == nullptr || bCoolingDown)
+	{
+		Denials++;
+		INC_DWORD_STAT(STAT_AttackTokenDenials);
+		return false;
+	}
+
+	FreeToken->Holder = Attacker;
+	FreeToken->AcquiredTime = CurrentTime;
+	Grants++;
+	INC_DWORD_STAT(STAT_AttackTokenGrants);
+	return true;
+}
+
+void UAttackTokenComponent::ReleaseToken(AActor* Attacker)
+{
+	const float CurrentTime{ GetWorld()->GetTimeSeconds() };
+	for (FAttackToken& Token : Tokens)
+	{
+		if (Token.Holder == Attacker)
+		{
+			Token.Holder = nullptr;
+			Token.AvailableTime = CurrentTime + TokenCooldown;
+			AttackerCooldowns.Emplace(Attacker, CurrentTime + AttackerCooldown);
+			return;
+		}
+	}
+}
+
+int32 UAttackTokenComponent::GetNumHeldTokens() const
+{
+	int32 NumHeld{ 0 };
+	for (const FAttackToken& Token : Tokens)
+	{
+		NumHeld += Token.Holder.IsValid() ? 1 : 0;
+	}
+	return NumHeld;
+}
+
+void UAttackTokenComponent::ExpireTokens(float CurrentTime)
+{
+	for (FAttackToken& Token : Tokens)
+	{
+		if (Token.Holder.IsValid() && CurrentTime - Token.AcquiredTime <= MaxHoldTime) continue;
+
+		// A destroyed holder leaves a stale weak pointer; only a real hold starts the cooldown
+		if (!Token.Holder.IsExplicitlyNull())
+		{
+			Token.AvailableTime = CurrentTime + TokenCooldown;
+		}
+		Token.Holder = nullptr;
+	}
+}
+
+void UAttackTokenComponent::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("%s: %d of %d attack tokens held, %d grants, %d denials"),
+		*GetNameSafe(GetOwner()),
+		GetNumHeldTokens(),
+		Tokens.Num(),
+		Grants,
+		Denials);
+}
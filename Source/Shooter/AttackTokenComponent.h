@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AttackTokenComponent.generated.h"
+
+/** One attack slot on the target */
+struct FAttackToken
+{
+	TWeakObjectPtr<AActor> Holder;
+
+	/** World time the holder took the token */
+	float AcquiredTime = 0.f;
+
+	/** World time the token can be handed out again after its release */
+	float AvailableTime = 0.f;
+};
+
+/**
+ * Limits how many enemies attack its owner at once. An enemy needs a token
+ * to start an attack; only MaxTokens are held at a time, a released token
+ * cools down before it is handed out again, and an attacker waits before it
+ * may take another one, so the tokens rotate through the horde.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SHOOTER_API UAttackTokenComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAttackTokenComponent();
+
+	/** True if Attacker holds a token, or took a free one now */
+	bool RequestToken(AActor* Attacker);
+
+	/** Returns Attacker's token, if it holds one */
+	void ReleaseToken(AActor* Attacker);
+
+	int32 GetNumHeldTokens() const;
+
+	/** Logs held tokens and the grants and denials so far */
+	void LogReport() const;
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	/** Frees tokens whose holder is gone or held them longer than MaxHoldTime */
+	void ExpireTokens(float CurrentTime);
+
+	/** Enemies attacking at once */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 MaxTokens;
+
+	/** Seconds a released token stays unavailable */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float TokenCooldown;
+
+	/** Seconds after a release before the same attacker may take a token again */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float AttackerCooldown;
+
+	/** Tokens held longer than this are taken back */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float MaxHoldTime;
+
+	TArray<FAttackToken> Tokens;
+
+	/** Attackers that released a token recently, and when they may take one again */
+	TArray<TPair<TWeakObjectPtr<AActor>, float>> AttackerCooldowns;
+
+	int32 Grants;
+	int32 Denials;
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_FlowFieldChase.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "FlowFieldSubsystem.h"
+
+UBTTask_FlowFieldChase::UBTTask_FlowFieldChase() :
+	AcceptanceRadius(100.f)
+{
+	NodeName = TEXT("Flow Field Chase");
+	bNotifyTick = true;
+	bNotifyTaskFinished = true;
+
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_FlowFieldChase, TargetKey), AActor::StaticClass());
+}
+
+EBTNodeResult::Type UBTTask_FlowFieldChase::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* Controller{ OwnerComp.GetAIOwner() };
+	const UBlackboardComponent* Blackboard{ OwnerComp.GetBlackboardComponent() };
+	AActor* Target{ Blackboard ? Cast<AActor>(Blackboard->GetValueAsObject(TargetKey.SelectedKeyName)) : nullptr };
+	UFlowFieldSubsystem* FlowFields{ GetWorld()->GetSubsystem<UFlowFieldSubsystem>() };
+	if (Controller == nullptr || Controller->GetPawn() == nullptr || Target == nullptr || FlowFields == nullptr)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	if (FVector::DistSquared2D(Controller->GetPawn()->GetActorLocation(), Target->GetActorLocation()) <= FMath::Square(AcceptanceRadius))
+	{
+		return EBTNodeResult::Succeeded;
+	}
+
+	FlowFields->StartChase(Controller, Target, AcceptanceRadius);
+	return EBTNodeResult::InProgress;
+}
+
+void UBTTask_FlowFieldChase::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult)
+{
+	// Also runs after an abort
+	if (UFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UFlowFieldSubsystem>())
+	{
+		FlowFields->StopChase(OwnerComp.GetAIOwner());
+	}
+
+	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+}
+
+FString UBTTask_FlowFieldChase::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *TargetKey.SelectedKeyName.ToString());
+}
+
+void UBTTask_FlowFieldChase::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	const AAIController* Controller{ OwnerComp.GetAIOwner() };
+	const UBlackboardComponent* Blackboard{ OwnerComp.GetBlackboardComponent() };
+	const AActor* Target{ Blackboard ? Cast<AActor>(Blackboard->GetValueAsObject(TargetKey.SelectedKeyName)) : nullptr };
+	const APawn* Pawn{ Controller ? Controller->GetPawn() : nullptr };
+	if (Pawn == nullptr || Target == nullptr)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	if (FVector::DistSquared2D(Pawn->GetActorLocation(), Target->GetActorLocation()) <= FMath::Square(AcceptanceRadius))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_FlowFieldChase.generated.h"
+
+/**
+ * Chases the blackboard target along its shared flow field. Use in place of
+ * MoveTo when many enemies chase the same player.
+ */
+UCLASS()
+class SHOOTER_API UBTTask_FlowFieldChase : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UBTTask_FlowFieldChase();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	/** Actor to chase */
+	UPROPERTY(EditAnywhere, Category = Blackboard, meta = (AllowPrivateAccess = "true"))
+	FBlackboardKeySelector TargetKey;
+
+	/** The task succeeds within this distance of the target */
+	UPROPERTY(EditAnywhere, Category = Node, meta = (AllowPrivateAccess = "true"))
+	float AcceptanceRadius;
+};
@@ -9,14 +9,28 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/BoxComponent.h"
+#include "Components/SphereComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
+#include "LootTable.h"
+#include "ItemPoolSubsystem.h"
+#include "AILODSubsystem.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "EnemyCrowdSubsystem.h"
+#include "EnemyMovementComponent.h"
+#include "EnemyVirtualizationSubsystem.h"
+#include "GruxDecisionSubsystem.h"
+#include "AttackTokenComponent.h"
+#include "BrainComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Melee Sweep"), STAT_EnemyMeleeSweep, STATGROUP_Shooter);
 
 // Sets default values
-AEnemy::AEnemy() :
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer.SetDefaultSubobjectClass<UEnemyMovementComponent>(ACharacter::CharacterMovementComponentName)),
 	Health(100.f),
 	MaxHealth(100.f),
 	HealthBarDisplayTime(4.f),
@@ -24,36 +38,93 @@ AEnemy::AEnemy() :
 	HitReactTimeMin(.5f),
 	HitReactTimeMax(3.f),
 	HitNumberDestroyTime(1.5f),
+	PatrolIndex(0),
+	AgroRadius(1000.f),
+	PerceptionInterval(0.f),
+	DecisionInterval(0.f),
 	bStunned(false),
 	StunChance(0.5f),
+	bInAttackRange(false),
+	CombatRange(150.f),
 	AttackLFast(TEXT("AttackLFast")),
 	AttackRFast(TEXT("AttackRFast")),
 	AttackL(TEXT("AttackL")),
 	AttackR(TEXT("AttackR")),
 	BaseDamage(20.f),
+	LeftWeaponBone(TEXT("weapon_l")),
+	RightWeaponBone(TEXT("weapon_r")),
 	LeftWeaponSocket(TEXT("FX_Trail_L_01")),
 	RightWeaponSocket(TEXT("FX_Trail_R_01")),
+	WeaponBladePoints(4),
+	WeaponSweepRadius(12.f),
+	MaxSweepSubstepLength(30.f),
+	MaxSweepSubsteps(8),
 	bCanAttack(true),
 	AttackWaitTime(1.f),
+	bWaitingForAttackToken(false),
 	bDying(false),
-	DeathTime(4.f)
+	bDormant(false),
+	DeathTime(4.f),
+	LootTable(nullptr),
+	LootScatterRadius(80.f)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	// Create the Agro Sphere
-	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
-	AgroSphere->SetupAttachment(GetRootComponent());
+	// Enemies materialized by the virtualization subsystem are spawned, not placed
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	// Perception no longer uses the spheres; a zero radius marks one that has nothing to migrate.
+	// They are neither attached nor registered, so they never update with the actor
+	AgroSphere_DEPRECATED = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
+	AgroSphere_DEPRECATED->bAutoRegister = false;
+	AgroSphere_DEPRECATED->InitSphereRadius(0.f);
+	AgroSphere_DEPRECATED->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AgroSphere_DEPRECATED->SetGenerateOverlapEvents(false);
+
+	CombatRangeSphere_DEPRECATED = CreateDefaultSubobject<USphereComponent>(TEXT("CombatRange"));
+	CombatRangeSphere_DEPRECATED->bAutoRegister = false;
+	CombatRangeSphere_DEPRECATED->InitSphereRadius(0.f);
+	CombatRangeSphere_DEPRECATED->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CombatRangeSphere_DEPRECATED->SetGenerateOverlapEvents(false);
+}
 
-	// Create the Combat Range Sphere
-	CombatRangeSphere = CreateDefaultSubobject<USphereComponent>(TEXT("CombatRange"));
-	CombatRangeSphere->SetupAttachment(GetRootComponent());
+void AEnemy::PostLoad()
+{
+	Super::PostLoad();
 
-	// Construct left and right weapon collision boxes
-	LeftWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Left Weapon Box"));
-	LeftWeaponCollision->SetupAttachment(GetMesh(), FName("LeftWeaponBone"));
-	RightWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Right Weapon Box"));
-	RightWeaponCollision->SetupAttachment(GetMesh(), FName("RightWeaponBone"));
+	// Zeroed once copied, so the next save keeps later edits to the radius properties
+	if (AgroSphere_DEPRECATED && AgroSphere_DEPRECATED->GetUnscaledSphereRadius() > 0.f)
+	{
+		AgroRadius = AgroSphere_DEPRECATED->GetUnscaledSphereRadius();
+		AgroSphere_DEPRECATED->SetSphereRadius(0.f, false);
+	}
+	if (CombatRangeSphere_DEPRECATED && CombatRangeSphere_DEPRECATED->GetUnscaledSphereRadius() > 0.f)
+	{
+		CombatRange = CombatRangeSphere_DEPRECATED->GetUnscaledSphereRadius();
+		CombatRangeSphere_DEPRECATED->SetSphereRadius(0.f, false);
+	}
+}
+
+void AEnemy::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Blueprints saved before the migration still attach the spheres to the capsule
+	const UWorld* World{ GetWorld() };
+	if (World && World->IsGameWorld())
+	{
+		if (AgroSphere_DEPRECATED)
+		{
+			AgroSphere_DEPRECATED->DestroyComponent();
+			AgroSphere_DEPRECATED = nullptr;
+		}
+		if (CombatRangeSphere_DEPRECATED)
+		{
+			CombatRangeSphere_DEPRECATED->DestroyComponent();
+			CombatRangeSphere_DEPRECATED = nullptr;
+		}
+	}
 }
 
 // Called when the game starts or when spawned
@@ -61,37 +132,19 @@ void AEnemy::BeginPlay()
 {
 	Super::BeginPlay();
 
-	AgroSphere->OnComponentBeginOverlap.AddDynamic(
-		this, 
-		&AEnemy::AgroSphereOverlap);
-	CombatRangeSphere->OnComponentBeginOverlap.AddDynamic(
+	// Attack windows sweep the weapon paths after animation has posed the mesh
+	GetMesh()->OnBoneTransformsFinalized.AddDynamic(
 		this,
-		&AEnemy::CombatRangeOverlap);
-	CombatRangeSphere->OnComponentEndOverlap.AddDynamic(
-		this,
-		&AEnemy::CombatRangeEndOverlap);
+		&AEnemy::OnBoneTransformsFinalized);
+
+	// The attack token is held for the whole swing, recovery included
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->OnMontageBlendingOut.AddDynamic(
+			this,
+			&AEnemy::OnAttackMontageBlendingOut);
+	}
 
-	// Bind functions to overlap events for weapon boxes
-	LeftWeaponCollision->OnComponentBeginOverlap.AddDynamic(
-		this,
-		&AEnemy::OnLeftWeaponOverlap);
-	RightWeaponCollision->OnComponentBeginOverlap.AddDynamic(
-		this,
-		&AEnemy::OnRightWeaponOverlap);
-	// Set collision presets for weapon boxes
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	LeftWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	LeftWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	LeftWeaponCollision->SetCollisionResponseToChannel(
-		ECollisionChannel::ECC_Pawn, 
-		ECollisionResponse::ECR_Overlap);
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	RightWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	RightWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	RightWeaponCollision->SetCollisionResponseToChannel(
-		ECollisionChannel::ECC_Pawn,
-		ECollisionResponse::ECR_Overlap);
-	
 	GetMesh()->SetCollisionResponseToChannel(
 		ECollisionChannel::ECC_Visibility, 
 		ECollisionResponse::ECR_Block);
@@ -114,25 +167,237 @@ void AEnemy::BeginPlay()
 			true);
 	}
 
-	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(
-		GetActorTransform(), 
-		PatrolPoint);
-	const FVector WorldPatrolPoint2 = UKismetMathLibrary::TransformLocation(
-		GetActorTransform(),
-		PatrolPoint2);
+	WorldPatrolRoute.Reset(PatrolRoute.Num() + 2);
+	WorldPatrolRoute.Add(UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint));
+	WorldPatrolRoute.Add(UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint2));
+	for (const FVector& Waypoint : PatrolRoute)
+	{
+		WorldPatrolRoute.Add(UKismetMathLibrary::TransformLocation(GetActorTransform(), Waypoint));
+	}
+	PatrolIndex = 0;
 
 	if (EnemyController)
 	{
+		// The behavior tree patrols between the first two waypoints only
 		EnemyController->GetBlackboardComponent()->SetValueAsVector(
 				TEXT("PatrolPoint"), 
-				WorldPatrolPoint);
+				WorldPatrolRoute[0]);
 
 		EnemyController->GetBlackboardComponent()->SetValueAsVector(
 			TEXT("PatrolPoint2"),
-			WorldPatrolPoint2);
+			WorldPatrolRoute[1]);
 
 		EnemyController->RunBehaviorTree(BehaviorTree);
 	}
+
+	RegisterWithSubsystems();
+
+	// Far from the player the enemy is kept as a record instead of an actor
+	if (UEnemyVirtualizationSubsystem* Virtualization = GetWorld()->GetSubsystem<UEnemyVirtualizationSubsystem>())
+	{
+		Virtualization->RegisterEnemy(this);
+	}
+
+	// Keep enough loot items pooled that mass deaths do not spawn actors
+	UItemPoolSubsystem* ItemPool{ GetWorld()->GetSubsystem<UItemPoolSubsystem>() };
+	if (LootTable && ItemPool)
+	{
+		for (const FLootEntry& Entry : LootTable->GetEntries())
+		{
+			ItemPool->AddExpectedDrops(Entry.ItemClass, LootTable->GetExpectedDropCount(Entry));
+		}
+	}
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseAttackToken();
+	UnregisterFromSubsystems();
+	if (UEnemyVirtualizationSubsystem* Virtualization = GetWorld()->GetSubsystem<UEnemyVirtualizationSubsystem>())
+	{
+		Virtualization->UnregisterEnemy(this);
+	}
+
+	UItemPoolSubsystem* ItemPool{ GetWorld()->GetSubsystem<UItemPoolSubsystem>() };
+	if (LootTable && ItemPool)
+	{
+		for (const FLootEntry& Entry : LootTable->GetEntries())
+		{
+			ItemPool->AddExpectedDrops(Entry.ItemClass, -LootTable->GetExpectedDropCount(Entry));
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemy::RegisterWithSubsystems()
+{
+	// Throttles the behavior tree, perception and movement with distance from the player
+	if (UAILODSubsystem* AILOD = GetWorld()->GetSubsystem<UAILODSubsystem>())
+	{
+		AILOD->RegisterEnemy(this);
+	}
+
+	// Aggro and attack range are evaluated for all enemies in one pass
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterEnemy(this);
+	}
+
+	// Crowd avoidance is budgeted across all enemies
+	if (UEnemyCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>())
+	{
+		Crowd->RegisterEnemy(this);
+	}
+
+	// Decides in native code, or runs the behavior tree
+	if (UGruxDecisionSubsystem* Decisions = GetWorld()->GetSubsystem<UGruxDecisionSubsystem>())
+	{
+		Decisions->RegisterEnemy(this);
+	}
+}
+
+void AEnemy::UnregisterFromSubsystems()
+{
+	if (UAILODSubsystem* AILOD = GetWorld()->GetSubsystem<UAILODSubsystem>())
+	{
+		AILOD->UnregisterEnemy(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterEnemy(this);
+	}
+	if (UEnemyCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UEnemyCrowdSubsystem>())
+	{
+		Crowd->UnregisterEnemy(this);
+	}
+	if (UGruxDecisionSubsystem* Decisions = GetWorld()->GetSubsystem<UGruxDecisionSubsystem>())
+	{
+		Decisions->UnregisterEnemy(this);
+	}
+}
+
+void AEnemy::SaveRecord(FEnemyRecord& Record) const
+{
+	Record.EnemyClass = GetClass();
+	Record.Location = GetActorLocation();
+	Record.Yaw = GetActorRotation().Yaw;
+	Record.Health = Health;
+	Record.Target = AgroTarget;
+	Record.PatrolRoute = WorldPatrolRoute;
+	Record.PatrolIndex = PatrolIndex;
+}
+
+void AEnemy::RestoreRecord(const FEnemyRecord& Record)
+{
+	SetActorLocationAndRotation(
+		Record.Location,
+		FRotator(0.f, Record.Yaw, 0.f),
+		false,
+		nullptr,
+		ETeleportType::TeleportPhysics);
+
+	// A pooled actor may have served another record since it went dormant
+	ResetCombatState();
+
+	Health = Record.Health;
+	AgroTarget = Record.Target;
+
+	WorldPatrolRoute = Record.PatrolRoute;
+	PatrolIndex = WorldPatrolRoute.IsValidIndex(Record.PatrolIndex) ? Record.PatrolIndex : 0;
+
+	UBlackboardComponent* Blackboard{ EnemyController ? EnemyController->GetBlackboardComponent() : nullptr };
+	if (Blackboard == nullptr) return;
+
+	Blackboard->SetValueAsObject(TEXT("Target"), Record.Target.Get());
+	if (WorldPatrolRoute.Num() > 0)
+	{
+		// The behavior tree patrol heads to the blackboard PatrolPoint first
+		Blackboard->SetValueAsVector(TEXT("PatrolPoint"), WorldPatrolRoute[PatrolIndex]);
+		Blackboard->SetValueAsVector(TEXT("PatrolPoint2"), WorldPatrolRoute[(PatrolIndex + 1) % WorldPatrolRoute.Num()]);
+	}
+}
+
+void AEnemy::ResetCombatState()
+{
+	bStunned = false;
+	bInAttackRange = false;
+	bCanAttack = true;
+	bWaitingForAttackToken = false;
+	bCanHitReact = true;
+	AgroTarget = nullptr;
+	PerceptionInterval = 0.f;
+	DecisionInterval = 0.f;
+
+	ReleaseAttackToken();
+	DiscardAttackWindow(LeftWeaponWindow);
+	DiscardAttackWindow(RightWeaponWindow);
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+
+	if (UBlackboardComponent* Blackboard = EnemyController ? EnemyController->GetBlackboardComponent() : nullptr)
+	{
+		Blackboard->SetValueAsObject(TEXT("Target"), nullptr);
+		Blackboard->SetValueAsBool(TEXT("CanAttack"), true);
+		Blackboard->SetValueAsBool(TEXT("Stunned"), false);
+		Blackboard->SetValueAsBool(TEXT("InAttackRange"), false);
+	}
+}
+
+void AEnemy::SetDormant(bool bInDormant)
+{
+	if (bDormant == bInDormant) return;
+	bDormant = bInDormant;
+
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+	SetActorTickEnabled(!bDormant);
+	GetMesh()->SetComponentTickEnabled(!bDormant);
+	GetCharacterMovement()->SetComponentTickEnabled(!bDormant);
+
+	UBrainComponent* Brain{ EnemyController ? EnemyController->GetBrainComponent() : nullptr };
+	UCrowdFollowingComponent* CrowdFollowing{ EnemyController ? Cast<UCrowdFollowingComponent>(EnemyController->GetPathFollowingComponent()) : nullptr };
+
+	if (bDormant)
+	{
+		GetWorldTimerManager().ClearAllTimersForObject(this);
+		HideHealthBar();
+		ResetCombatState();
+		for (auto& HitPair : HitNumbers)
+		{
+			HitPair.Key->RemoveFromParent();
+		}
+		HitNumbers.Empty();
+
+		GetCharacterMovement()->StopMovementImmediately();
+		if (EnemyController)
+		{
+			EnemyController->StopMovement();
+		}
+		if (Brain)
+		{
+			Brain->StopLogic(TEXT("Dormant"));
+		}
+		// Dormant enemies must not be avoided by the crowd
+		if (CrowdFollowing)
+		{
+			CrowdFollowing->SetCrowdSimulationState(ECrowdSimulationState::Disabled);
+		}
+		UnregisterFromSubsystems();
+	}
+	else
+	{
+		GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+		if (CrowdFollowing)
+		{
+			CrowdFollowing->SetCrowdSimulationState(ECrowdSimulationState::Enabled);
+		}
+		// The Grux decision subsystem restarts the behavior tree unless native decisions are on
+		RegisterWithSubsystems();
+	}
 }
 
 void AEnemy::ShowHealthBar_Implementation()
@@ -152,6 +417,11 @@ void AEnemy::Die()
 
 	HideHealthBar();
 
+	// The death montage cuts the attack before its close notify; a dying swing deals no damage
+	DiscardAttackWindow(LeftWeaponWindow);
+	DiscardAttackWindow(RightWeaponWindow);
+	ReleaseAttackToken();
+
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 	if (AnimInstance && DeathMontage)
 	{
@@ -166,6 +436,33 @@ void AEnemy::Die()
 		);
 		EnemyController->StopMovement();
 	}
+
+	DropLoot();
+}
+
+void AEnemy::DropLoot()
+{
+	UItemPoolSubsystem* ItemPool{ GetWorld()->GetSubsystem<UItemPoolSubsystem>() };
+	if (LootTable == nullptr || ItemPool == nullptr) return;
+
+	TArray<FLootDrop> Drops;
+	LootTable->RollLoot(Drops);
+
+	// Drop at the enemy's feet
+	const FVector FeetLocation{ GetActorLocation() - FVector(0.f, 0.f, GetCapsuleComponent()->GetScaledCapsuleHalfHeight()) };
+	for (const FLootDrop& Drop : Drops)
+	{
+		const FVector2D Scatter{ FMath::RandPointInCircle(LootScatterRadius) };
+		const FTransform DropTransform{
+			FRotator(0.f, FMath::FRandRange(0.f, 360.f), 0.f),
+			FeetLocation + FVector(Scatter, 0.f) };
+
+		ItemPool->AcquireItem(Drop.ItemClass, DropTransform, [&Drop](AItem* Item)
+		{
+			Item->SetItemRarity(Drop.Rarity);
+			Item->SetItemCount(Drop.ItemCount);
+		});
+	}
 }
 
 void AEnemy::PlayHitMontage(FName Section, float PlayRate)
@@ -229,79 +526,77 @@ void AEnemy::UpdateHitNumbers()
 	}
 }
 
-void AEnemy::AgroSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+AActor* AEnemy::GetAgroTarget() const
+{
+	return AgroTarget.Get();
+}
+
+void AEnemy::SetAgroTarget(AActor* Target)
 {
-	if (OtherActor == nullptr) return;
+	if (AgroTarget != Target)
+	{
+		ReleaseAttackToken();
+		bWaitingForAttackToken = false;
+	}
+	AgroTarget = Target;
 
-	auto Character = Cast<AShooterCharacter>(OtherActor);
-	if (Character)
+	if (EnemyController)
 	{
-		if (EnemyController)
+		if (EnemyController->GetBlackboardComponent())
 		{
-			if (EnemyController->GetBlackboardComponent())
-			{
-				EnemyController->GetBlackboardComponent()->SetValueAsObject(
-					TEXT("Target"),
-					Character);
-			}
+			EnemyController->GetBlackboardComponent()->SetValueAsObject(
+				TEXT("Target"),
+				Target);
 		}
 	}
+
+	if (UAILODSubsystem* AILOD = GetWorld()->GetSubsystem<UAILODSubsystem>())
+	{
+		AILOD->PromoteEnemy(this);
+	}
 }
 
-void AEnemy::SetStunned(bool Stunned)
+void AEnemy::SetInAttackRange(bool bInRange)
 {
-	bStunned = Stunned;
+	if (bInAttackRange == bInRange) return;
 
+	bInAttackRange = bInRange;
 	if (EnemyController)
 	{
 		EnemyController->GetBlackboardComponent()->SetValueAsBool(
-			TEXT("Stunned"), 
-			Stunned);
+			TEXT("InAttackRange"),
+			bInRange
+		);
 	}
 }
 
-void AEnemy::CombatRangeOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::SetStunned(bool Stunned)
 {
-	if (OtherActor == nullptr) return;
-	auto ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-	if (ShooterCharacter)
-	{
-		bInAttackRange = true;
-		if (EnemyController)
-		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(
-				TEXT("InAttackRange"),
-				true
-			);
-		}
-	}
-}
+	bStunned = Stunned;
 
-void AEnemy::CombatRangeEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
-{
-	if (OtherActor == nullptr) return;
-	auto ShooterCharacter = Cast<AShooterCharacter>(OtherActor);
-	if (ShooterCharacter)
+	if (EnemyController)
 	{
-		bInAttackRange = false;
-		if (EnemyController)
-		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(
-				TEXT("InAttackRange"),
-				false
-			);
-		}
+		EnemyController->GetBlackboardComponent()->SetValueAsBool(
+			TEXT("Stunned"), 
+			Stunned);
 	}
-
 }
 
 void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
 {
+	// Without a token the swing is skipped, but the attack wait still runs so the behavior tree backs off
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && AttackMontage)
+	if (AnimInstance && AttackMontage && RequestAttackToken())
 	{
-		AnimInstance->Montage_Play(AttackMontage);
-		AnimInstance->Montage_JumpToSection(Section, AttackMontage);
+		if (AnimInstance->Montage_Play(AttackMontage) > 0.f)
+		{
+			AnimInstance->Montage_JumpToSection(Section, AttackMontage);
+		}
+		else
+		{
+			// No blend out will come to give the token back
+			ReleaseAttackToken();
+		}
 	}
 	bCanAttack = false;
 	GetWorldTimerManager().SetTimer(
@@ -340,6 +635,49 @@ FName AEnemy::GetAttackSectionName()
 	return SectionName;
 }
 
+void AEnemy::PlayRandomAttack()
+{
+	PlayAttackMontage(GetAttackSectionName(), 1.0f);
+}
+
+FVector AEnemy::GetPatrolDestination() const
+{
+	return WorldPatrolRoute.IsValidIndex(PatrolIndex) ? WorldPatrolRoute[PatrolIndex] : GetActorLocation();
+}
+
+void AEnemy::AdvancePatrol()
+{
+	if (WorldPatrolRoute.Num() > 0)
+	{
+		PatrolIndex = (PatrolIndex + 1) % WorldPatrolRoute.Num();
+	}
+}
+
+bool AEnemy::RequestAttackToken()
+{
+	const AShooterCharacter* Target{ Cast<AShooterCharacter>(AgroTarget.Get()) };
+	UAttackTokenComponent* AttackTokens{ Target ? Target->GetAttackTokens() : nullptr };
+	if (AttackTokens == nullptr)
+	{
+		bWaitingForAttackToken = false;
+		return true;
+	}
+
+	// Also true when this enemy still holds its token; a token held too long may have been taken back
+	bWaitingForAttackToken = !AttackTokens->RequestToken(this);
+	HeldAttackTokens = bWaitingForAttackToken ? nullptr : AttackTokens;
+	return !bWaitingForAttackToken;
+}
+
+void AEnemy::ReleaseAttackToken()
+{
+	if (UAttackTokenComponent* AttackTokens = HeldAttackTokens.Get())
+	{
+		AttackTokens->ReleaseToken(this);
+	}
+	HeldAttackTokens.Reset();
+}
+
 void AEnemy::DoDamage(AShooterCharacter* Victim)
 {
 	if (Victim == nullptr) return;
@@ -390,6 +728,17 @@ void AEnemy::StunCharacter(AShooterCharacter* Victim)
 	}
 }
 
+void AEnemy::OnAttackMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted)
+{
+	if (Montage != AttackMontage) return;
+
+	// Blend out events are queued, so a swing that replaced this one may already hold the token
+	const UAnimInstance* AnimInstance{ GetMesh()->GetAnimInstance() };
+	if (AnimInstance && AnimInstance->Montage_IsActive(AttackMontage)) return;
+
+	ReleaseAttackToken();
+}
+
 void AEnemy::ResetCanAttack()
 {
 	bCanAttack = true;
@@ -418,46 +767,155 @@ void AEnemy::DestroyEnemy()
 	Destroy();
 }
 
-void AEnemy::OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::GetWeaponBladePoints(FName BoneName, FName SocketName, const FTransform& ActorTransform, FWeaponBladePoints& OutLocalPoints) const
+{
+	OutLocalPoints.Reset();
+
+	const USkeletalMeshComponent* MeshComponent{ GetMesh() };
+	const FVector TipLocation{ ActorTransform.InverseTransformPosition(MeshComponent->GetSocketLocation(SocketName)) };
+	const int32 NumPoints{ MeshComponent->DoesSocketExist(BoneName) ? FMath::Clamp(WeaponBladePoints, 1, MaxWeaponBladePoints) : 1 };
+	if (NumPoints == 1)
+	{
+		OutLocalPoints.Add(TipLocation);
+		return;
+	}
+
+	const FVector BaseLocation{ ActorTransform.InverseTransformPosition(MeshComponent->GetSocketLocation(BoneName)) };
+	for (int32 Point = 0; Point < NumPoints; Point++)
+	{
+		OutLocalPoints.Add(FMath::Lerp(BaseLocation, TipLocation, static_cast<float>(Point) / (NumPoints - 1)));
+	}
+}
+
+void AEnemy::OpenAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName)
+{
+	Window.bOpen = true;
+	Window.HitActors.Reset();
+	Window.LastActorTransform = GetActorTransform();
+	GetWeaponBladePoints(BoneName, SocketName, Window.LastActorTransform, Window.LastLocalPoints);
+}
+
+void AEnemy::CloseAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName)
+{
+	if (!Window.bOpen) return;
+
+	SweepAttackWindow(Window, BoneName, SocketName);
+	DiscardAttackWindow(Window);
+}
+
+void AEnemy::DiscardAttackWindow(FMeleeAttackWindow& Window)
 {
-	auto Character = Cast<AShooterCharacter>(OtherActor);
-	if (Character)
+	Window.bOpen = false;
+	Window.HitActors.Reset();
+}
+
+void AEnemy::SweepAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyMeleeSweep);
+
+	const FTransform ActorTransform{ GetActorTransform() };
+	FWeaponBladePoints LocalPoints;
+	GetWeaponBladePoints(BoneName, SocketName, ActorTransform, LocalPoints);
+
+	// The blade points of the last pose no longer match if WeaponBladePoints changed mid-swing
+	if (LocalPoints.Num() != Window.LastLocalPoints.Num())
+	{
+		Window.LastActorTransform = ActorTransform;
+		Window.LastLocalPoints = LocalPoints;
+		return;
+	}
+
+	// Substeps follow the swing in actor space, so turning and lunging curve the path like the animation does.
+	// The point travelling furthest, usually the tip, decides how many are needed.
+	float MaxDistance{ 0.f };
+	for (int32 Point = 0; Point < LocalPoints.Num(); Point++)
+	{
+		MaxDistance = FMath::Max(MaxDistance, FVector::Dist(
+			Window.LastActorTransform.TransformPosition(Window.LastLocalPoints[Point]),
+			ActorTransform.TransformPosition(LocalPoints[Point])));
+	}
+	const int32 NumSubsteps{ FMath::Clamp(
+		FMath::CeilToInt(MaxDistance / FMath::Max(MaxSweepSubstepLength, 1.f)),
+		1,
+		FMath::Max(MaxSweepSubsteps, 1)) };
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemyMeleeSweep), false, this);
+	const FCollisionShape Sphere{ FCollisionShape::MakeSphere(WeaponSweepRadius) };
+	FTransform SubstepTransform;
+	FWeaponBladePoints SubstepStarts;
+	for (int32 Point = 0; Point < LocalPoints.Num(); Point++)
 	{
-		DoDamage(Character);
-		SpawnBlood(Character, LeftWeaponSocket);
-		StunCharacter(Character);
+		SubstepStarts.Add(Window.LastActorTransform.TransformPosition(Window.LastLocalPoints[Point]));
 	}
+	TArray<FHitResult> Hits;
+
+	for (int32 Substep = 1; Substep <= NumSubsteps; Substep++)
+	{
+		const float Alpha{ static_cast<float>(Substep) / NumSubsteps };
+		SubstepTransform.Blend(Window.LastActorTransform, ActorTransform, Alpha);
+
+		for (int32 Point = 0; Point < LocalPoints.Num(); Point++)
+		{
+			const FVector SubstepEnd{ SubstepTransform.TransformPosition(FMath::Lerp(Window.LastLocalPoints[Point], LocalPoints[Point], Alpha)) };
+
+			GetWorld()->SweepMultiByObjectType(
+				Hits,
+				SubstepStarts[Point],
+				SubstepEnd,
+				FQuat::Identity,
+				FCollisionObjectQueryParams(ECollisionChannel::ECC_Pawn),
+				Sphere,
+				QueryParams);
+
+			for (const FHitResult& Hit : Hits)
+			{
+				AShooterCharacter* Character{ Cast<AShooterCharacter>(Hit.GetActor()) };
+				if (Character == nullptr || Window.HitActors.Contains(Character)) continue;
+
+				// One hit per victim per swing
+				Window.HitActors.Add(Character);
+				DoDamage(Character);
+				SpawnBlood(Character, SocketName);
+				StunCharacter(Character);
+			}
+			SubstepStarts[Point] = SubstepEnd;
+		}
+	}
+
+	Window.LastActorTransform = ActorTransform;
+	Window.LastLocalPoints = LocalPoints;
 }
 
-void AEnemy::OnRightWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::OnBoneTransformsFinalized()
 {
-	auto Character = Cast<AShooterCharacter>(OtherActor);
-	if (Character)
+	if (LeftWeaponWindow.bOpen)
+	{
+		SweepAttackWindow(LeftWeaponWindow, LeftWeaponBone, LeftWeaponSocket);
+	}
+	if (RightWeaponWindow.bOpen)
 	{
-		DoDamage(Character);
-		SpawnBlood(Character, RightWeaponSocket);
-		StunCharacter(Character);
+		SweepAttackWindow(RightWeaponWindow, RightWeaponBone, RightWeaponSocket);
 	}
 }
 
 void AEnemy::ActivateLeftWeapon()
 {
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	OpenAttackWindow(LeftWeaponWindow, LeftWeaponBone, LeftWeaponSocket);
 }
 
 void AEnemy::DeactivateLeftWeapon()
 {
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CloseAttackWindow(LeftWeaponWindow, LeftWeaponBone, LeftWeaponSocket);
 }
 
 void AEnemy::ActivateRightWeapon()
 {
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	OpenAttackWindow(RightWeaponWindow, RightWeaponBone, RightWeaponSocket);
 }
 
 void AEnemy::DeactivateRightWeapon()
 {
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CloseAttackWindow(RightWeaponWindow, RightWeaponBone, RightWeaponSocket);
 }
 
 // Called every frame
@@ -490,12 +948,7 @@ void AEnemy::BulletHit_Implementation(FHitResult HitResult, AActor* Shooter, ACo
 float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// Set the Target Blackboard Key to agro the Character
-	if (EnemyController)
-	{
-		EnemyController->GetBlackboardComponent()->SetValueAsObject(
-			FName("Target"),
-			DamageCauser);
-	}
+	SetAgroTarget(DamageCauser);
 	
 	if (Health - DamageAmount <= 0.f)
 	{
@@ -5,8 +5,31 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "BulletHitInterface.h"
+#include "EnemyRecord.h"
 #include "Enemy.generated.h"
 
+/** Most points sampled along one weapon blade */
+constexpr int32 MaxWeaponBladePoints{ 8 };
+
+using FWeaponBladePoints = TArray<FVector, TInlineAllocator<MaxWeaponBladePoints>>;
+
+/**
+ * One weapon's part of a melee swing, open between the attack's anim notifies.
+ * The paths of points along the blade since the last pose are swept in substeps,
+ * and each victim is hit at most once per window.
+ */
+struct FMeleeAttackWindow
+{
+	bool bOpen = false;
+
+	/** Blade points in actor space, and the actor transform, at the last sweep */
+	FWeaponBladePoints LastLocalPoints;
+	FTransform LastActorTransform;
+
+	/** Actors already hit in this window */
+	TArray<TWeakObjectPtr<AActor>, TInlineAllocator<2>> HitActors;
+};
+
 UCLASS()
 class SHOOTER_API AEnemy : public ACharacter, public IBulletHitInterface
 {
@@ -14,12 +37,20 @@ class SHOOTER_API AEnemy : public ACharacter, public IBulletHitInterface
 
 public:
 	// Sets default values for this character's properties
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Copies the radii of the deprecated perception spheres into AgroRadius and CombatRange */
+	virtual void PostLoad() override;
+
+	/** Destroys the deprecated perception spheres in game worlds; they only matter to PostLoad */
+	virtual void PostInitializeComponents() override;
+
 	UFUNCTION(BlueprintNativeEvent)
 	void ShowHealthBar();
 	void ShowHealthBar_Implementation();
@@ -41,48 +72,35 @@ protected:
 
 	void UpdateHitNumbers();
 
-	/** Called when something overlaps with the agro sphere */
-	UFUNCTION()
-	void AgroSphereOverlap(
-		UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult);
-
 	UFUNCTION(BlueprintCallable)
 	void SetStunned(bool Stunned);
 
-	UFUNCTION()
-	void CombatRangeOverlap(
-		UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult);
-
-	UFUNCTION()
-	void CombatRangeEndOverlap(
-		UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex);
-
 	UFUNCTION(BlueprintCallable)
 	void PlayAttackMontage(FName Section, float PlayRate);
 
 	UFUNCTION(BlueprintPure)
 	FName GetAttackSectionName();
 
+	/** Points from BoneName to SocketName in actor space; only the tip if the bone is missing */
+	void GetWeaponBladePoints(FName BoneName, FName SocketName, const FTransform& ActorTransform, FWeaponBladePoints& OutLocalPoints) const;
+
+	/** Starts sweeping the blade between BoneName and SocketName for hits */
+	void OpenAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName);
+
+	/** Sweeps the rest of the blade's path and stops */
+	void CloseAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName);
+
+	/** Stops without sweeping, for attacks cut short by death or dormancy */
+	static void DiscardAttackWindow(FMeleeAttackWindow& Window);
+
+	/** Sweeps the blade's path since the last sweep and applies hits */
+	void SweepAttackWindow(FMeleeAttackWindow& Window, FName BoneName, FName SocketName);
+
+	/** Sweeps open attack windows once the pose of this frame is final */
 	UFUNCTION()
-	void OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	
-	UFUNCTION()
-	void OnRightWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	void OnBoneTransformsFinalized();
 
-	// Activate/deactivate collision for weapon boxes
+	// Open/close the attack windows of the weapons; called from attack anim notifies
 	UFUNCTION(BlueprintCallable)
 	void ActivateLeftWeapon();
 	UFUNCTION(BlueprintCallable)
@@ -98,6 +116,10 @@ protected:
 	// Attempt to stun character
 	void StunCharacter(AShooterCharacter* Victim);
 
+	/** Gives back the attack token once the attack montage ends or is interrupted */
+	UFUNCTION()
+	void OnAttackMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted);
+
 	void ResetCanAttack();
 
 	UFUNCTION(BlueprintCallable)
@@ -106,6 +128,16 @@ protected:
 	UFUNCTION()
 	void DestroyEnemy();
 
+	/** Rolls the LootTable and places the drops from the item pool */
+	void DropLoot();
+
+	/** Clears the combat, aggro and LOD state that no record carries, for an actor entering or leaving the pool */
+	void ResetCombatState();
+
+	/** Registers with the AI LOD, perception and crowd subsystems */
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
+
 private:
 	/** Particles to spawn when hit by bullets */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -167,11 +199,30 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true", MakeEditWidget = "true"))
 	FVector PatrolPoint2;
 
+	/** Further waypoints visited after PatrolPoint2, in order; the patrol then loops back to PatrolPoint */
+	UPROPERTY(EditAnywhere, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true", MakeEditWidget = "true"))
+	TArray<FVector> PatrolRoute;
+
+	/** PatrolPoint, PatrolPoint2 and PatrolRoute in world space */
+	TArray<FVector> WorldPatrolRoute;
+
+	/** Index into WorldPatrolRoute of the waypoint the patrol heads to */
+	int32 PatrolIndex;
+
 	class AEnemyController* EnemyController;
 
-	/** Overlap sphere for when the enemy becomes hostile */
+	/** Set by SetAgroTarget; mirrored in the blackboard Target key */
+	TWeakObjectPtr<AActor> AgroTarget;
+
+	/** A player within this distance becomes the enemy's target */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class USphereComponent* AgroSphere;
+	float AgroRadius;
+
+	/** Seconds between perception checks; set by the AI LOD subsystem */
+	float PerceptionInterval;
+
+	/** Seconds between native decisions; set by the AI LOD subsystem */
+	float DecisionInterval;
 
 	/** True when playing the get hit animation */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -185,9 +236,17 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bInAttackRange;
 
-	/** Sphere for attack range */
+	/** A player within this distance is in attack range */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	USphereComponent* CombatRangeSphere;
+	float CombatRange;
+
+	/** Replaced by AgroRadius; kept so Blueprints load their radius. No collision */
+	UPROPERTY()
+	class USphereComponent* AgroSphere_DEPRECATED;
+
+	/** Replaced by CombatRange; kept so Blueprints load their radius. No collision */
+	UPROPERTY()
+	USphereComponent* CombatRangeSphere_DEPRECATED;
 
 	/** Montage containing different attacks */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -199,24 +258,43 @@ private:
 	FName AttackL;
 	FName AttackR;
 
-	/** Collision volume for the left weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* LeftWeaponCollision;
-
-	/** Collision volume for the right weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UBoxComponent* RightWeaponCollision;
+	FMeleeAttackWindow LeftWeaponWindow;
+	FMeleeAttackWindow RightWeaponWindow;
 
 	/** Base damage for enemy */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float BaseDamage;
 
+	/** Bone at the base of each weapon's blade */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FName LeftWeaponBone;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FName RightWeaponBone;
+
+	/** Socket at the tip of each weapon's blade */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	FName LeftWeaponSocket;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	FName RightWeaponSocket;
 
+	/** Number of points swept along each blade, base and tip included */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "8"))
+	int32 WeaponBladePoints;
+
+	/** Radius of the sphere swept along each blade point's path */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float WeaponSweepRadius;
+
+	/** Longest stretch of a weapon path covered by one sweep */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float MaxSweepSubstepLength;
+
+	/** Most sweeps per weapon per frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 MaxSweepSubsteps;
+
 	/** True when Enemy can attack */
 	UPROPERTY(VisibleAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bCanAttack;
@@ -227,18 +305,35 @@ private:
 	UPROPERTY(EditAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float AttackWaitTime;
 
+	/** Attack tokens of the target this enemy holds a token from */
+	TWeakObjectPtr<class UAttackTokenComponent> HeldAttackTokens;
+
+	/** True after the target denied an attack token; cleared when one is granted or the target changes */
+	bool bWaitingForAttackToken;
+
 	/** Death anim montage for the enemy */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UAnimMontage* DeathMontage;
 
 	bool bDying;
 
+	/** True while pooled by the enemy virtualization subsystem */
+	bool bDormant;
+
 	FTimerHandle DeathTimer;
 
 	/** Time after death until Destroy */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float DeathTime;
 
+	/** Items dropped on death */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Loot, meta = (AllowPrivateAccess = "true"))
+	class ULootTable* LootTable;
+
+	/** Max horizontal distance of a loot drop from the enemy */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Loot, meta = (AllowPrivateAccess = "true"))
+	float LootScatterRadius;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -256,4 +351,60 @@ public:
 	void ShowHitNumber(int32 Damage, FVector HitLocation, bool bHeadShot);
 
 	FORCEINLINE UBehaviorTree* GetBehaviorTree() const { return BehaviorTree; }
+	FORCEINLINE AEnemyController* GetEnemyController() const { return EnemyController; }
+
+	FORCEINLINE float GetAgroRadius() const { return AgroRadius; }
+	FORCEINLINE float GetCombatRange() const { return CombatRange; }
+	FORCEINLINE bool IsDying() const { return bDying; }
+	FORCEINLINE bool IsInAttackRange() const { return bInAttackRange; }
+
+	/** Seconds between perception checks; 0 checks on every perception tick. Set by the AI LOD subsystem */
+	FORCEINLINE float GetPerceptionInterval() const { return PerceptionInterval; }
+	FORCEINLINE void SetPerceptionInterval(float Interval) { PerceptionInterval = Interval; }
+
+	/** Seconds between Grux decisions; 0 decides on every decision pass. Set by the AI LOD subsystem */
+	FORCEINLINE float GetDecisionInterval() const { return DecisionInterval; }
+	FORCEINLINE void SetDecisionInterval(float Interval) { DecisionInterval = Interval; }
+
+	FORCEINLINE bool IsStunned() const { return bStunned; }
+	FORCEINLINE bool CanAttack() const { return bCanAttack; }
+	FORCEINLINE const TArray<FVector>& GetWorldPatrolRoute() const { return WorldPatrolRoute; }
+
+	/** Waypoint the patrol heads to; the enemy's own location before BeginPlay */
+	FVector GetPatrolDestination() const;
+
+	/** Heads the patrol for the next waypoint, looping back to the first */
+	void AdvancePatrol();
+
+	/** The blackboard Target, or nullptr */
+	AActor* GetAgroTarget() const;
+
+	/** Sets Target as the blackboard Target and moves this enemy to the top AI LOD bucket */
+	void SetAgroTarget(AActor* Target);
+
+	/** Updates bInAttackRange and the InAttackRange blackboard key */
+	void SetInAttackRange(bool bInRange);
+
+	/** Plays a random attack section; attacking is blocked for AttackWaitTime */
+	void PlayRandomAttack();
+
+	/** Takes an attack token from the target; true if this enemy may attack. Targets without attack tokens always allow it */
+	bool RequestAttackToken();
+
+	/** Gives back the attack token this enemy holds, if any */
+	void ReleaseAttackToken();
+
+	FORCEINLINE bool HasAttackToken() const { return HeldAttackTokens.IsValid(); }
+	FORCEINLINE bool IsWaitingForAttackToken() const { return bWaitingForAttackToken; }
+
+	/** Copies the state kept while virtualized into Record */
+	void SaveRecord(FEnemyRecord& Record) const;
+
+	/** Places this enemy and resets it to the state in Record */
+	void RestoreRecord(const FEnemyRecord& Record);
+
+	/** Hides the enemy and stops its AI, movement and animation while it waits in the pool */
+	void SetDormant(bool bInDormant);
+
+	FORCEINLINE bool IsDormant() const { return bDormant; }
 };
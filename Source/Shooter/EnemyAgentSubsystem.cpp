@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyAgentSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+
+bool UEnemyAgentSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World{ Cast<UWorld>(Outer) };
+	return World && World->IsGameWorld();
+}
+
+void UEnemyAgentSubsystem::GetPlayerLocations(FPlayerLocations& OutLocations) const
+{
+	OutLocations.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			OutLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyAgentSubsystem.generated.h"
+
+class AEnemy;
+
+/**
+ * Per-enemy agents of a subsystem in one dense array, looked up by enemy.
+ * AgentType needs a TWeakObjectPtr<AEnemy> Enemy member. Removing an agent
+ * moves the last one into its slot, so indices are only stable until the next
+ * removal.
+ */
+template<typename AgentType>
+class TEnemyAgentRegistry
+{
+public:
+	/** Adds a default agent for Enemy; returns its index, or INDEX_NONE if Enemy is null or already registered */
+	int32 Add(AEnemy* Enemy)
+	{
+		if (Enemy == nullptr || AgentIndices.Contains(Enemy)) return INDEX_NONE;
+
+		AgentType Agent;
+		Agent.Enemy = Enemy;
+		const int32 AgentIndex{ Agents.Add(Agent) };
+		AgentIndices.Add(Enemy, AgentIndex);
+		return AgentIndex;
+	}
+
+	/** Removes the agent of Enemy; returns false if it was not registered */
+	bool Remove(const AEnemy* Enemy)
+	{
+		int32 AgentIndex;
+		if (!AgentIndices.RemoveAndCopyValue(Enemy, AgentIndex)) return false;
+
+		Agents.RemoveAtSwap(AgentIndex);
+		if (Agents.IsValidIndex(AgentIndex))
+		{
+			// The last agent moved into the freed slot
+			if (const AEnemy* MovedEnemy = Agents[AgentIndex].Enemy.Get())
+			{
+				AgentIndices.Add(MovedEnemy, AgentIndex);
+			}
+		}
+		return true;
+	}
+
+	FORCEINLINE AgentType* Find(const AEnemy* Enemy)
+	{
+		const int32* AgentIndex{ AgentIndices.Find(Enemy) };
+		return AgentIndex ? &Agents[*AgentIndex] : nullptr;
+	}
+
+	FORCEINLINE const AgentType* Find(const AEnemy* Enemy) const
+	{
+		const int32* AgentIndex{ AgentIndices.Find(Enemy) };
+		return AgentIndex ? &Agents[*AgentIndex] : nullptr;
+	}
+
+	FORCEINLINE int32 Num() const { return Agents.Num(); }
+	FORCEINLINE bool IsValidIndex(int32 AgentIndex) const { return Agents.IsValidIndex(AgentIndex); }
+
+	FORCEINLINE AgentType& operator[](int32 AgentIndex) { return Agents[AgentIndex]; }
+	FORCEINLINE const AgentType& operator[](int32 AgentIndex) const { return Agents[AgentIndex]; }
+
+	FORCEINLINE auto begin() { return Agents.begin(); }
+	FORCEINLINE auto end() { return Agents.end(); }
+	FORCEINLINE auto begin() const { return Agents.begin(); }
+	FORCEINLINE auto end() const { return Agents.end(); }
+
+private:
+	TArray<AgentType> Agents;
+
+	/** Index into Agents of each registered enemy */
+	TMap<const AEnemy*, int32> AgentIndices;
+};
+
+/** Locations of the players' pawns; rarely more than a few */
+using FPlayerLocations = TArray<FVector, TInlineAllocator<4>>;
+
+/** Base of the world subsystems that manage enemies; they only exist in game worlds */
+UCLASS(Abstract)
+class SHOOTER_API UEnemyAgentSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+protected:
+	/** Locations of every player controller's pawn */
+	void GetPlayerLocations(FPlayerLocations& OutLocations) const;
+};
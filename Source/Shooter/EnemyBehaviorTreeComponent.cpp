@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyBehaviorTreeComponent.h"
+
+UEnemyBehaviorTreeComponent::UEnemyBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer),
+	MinTickInterval(0.f)
+{
+
+}
+
+void UEnemyBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// The tree accumulates the skipped time, so a longer interval only delays it.
+	// A disabled tick means the tree is waiting on a latent task or an event.
+	if (MinTickInterval > 0.f && IsComponentTickEnabled() && GetComponentTickInterval() < MinTickInterval)
+	{
+		SetComponentTickIntervalAndCooldown(MinTickInterval);
+	}
+}
+
+void UEnemyBehaviorTreeComponent::SetMinTickInterval(float Interval)
+{
+	MinTickInterval = FMath::Max(Interval, 0.f);
+}
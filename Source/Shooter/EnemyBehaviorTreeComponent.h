@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "EnemyBehaviorTreeComponent.generated.h"
+
+/**
+ * Behavior tree component whose tick can be spaced out by the AI LOD subsystem.
+ * The tree schedules its own next tick through the tick interval, so a plain
+ * SetComponentTickInterval is overwritten on the next tick; this component
+ * raises the interval the tree asked for to MinTickInterval after each tick
+ * instead. Execution requests still tick the tree on the next frame.
+ */
+UCLASS()
+class SHOOTER_API UEnemyBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyBehaviorTreeComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Seconds the tree waits at least between ticks; 0 lets it tick as often as it asks */
+	void SetMinTickInterval(float Interval);
+
+private:
+	float MinTickInterval;
+
+public:
+	FORCEINLINE float GetMinTickInterval() const { return MinTickInterval; }
+};
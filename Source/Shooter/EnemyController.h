@@ -7,14 +7,15 @@
 #include "EnemyController.generated.h"
 
 /**
- * 
+ * Moves along paths with detour crowd avoidance; the enemy crowd subsystem
+ * decides which enemies get full avoidance.
  */
 UCLASS()
 class SHOOTER_API AEnemyController : public AAIController
 {
 	GENERATED_BODY()
 public:
-	AEnemyController();
+	AEnemyController(const FObjectInitializer& ObjectInitializer);
 	virtual void OnPossess(APawn* InPawn) override;
 
 private:
@@ -22,12 +23,13 @@ private:
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBlackboardComponent* BlackboardComponent;
 
-	/** Behavior tree component for this enemy */
+	/** Behavior tree component for this enemy; also the brain, so RunBehaviorTree uses it */
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
-	class UBehaviorTreeComponent* BehaviorTreeComponent;
+	class UEnemyBehaviorTreeComponent* BehaviorTreeComponent;
 
 public:
 
 	FORCEINLINE UBlackboardComponent* GetBlackboardComponent() const { return BlackboardComponent; }
+	FORCEINLINE UEnemyBehaviorTreeComponent* GetBehaviorTreeComponent() const { return BehaviorTreeComponent; }
 	
 };
@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyCrowdSubsystem.h"
+#include "Engine/World.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Crowd"), STAT_EnemyCrowd, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Enemy Crowd Separation"), STAT_EnemyCrowdSeparation, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Avoiding Agents"), STAT_CrowdAvoidingAgents, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Separated Agents"), STAT_CrowdSeparatedAgents, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Agents Over Budget"), STAT_CrowdAgentsOverBudget, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld CrowdReportCommand(
+	TEXT("Shooter.Crowd.Report"),
+	TEXT("Logs enemies under crowd avoidance and soft separation in the last pass"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UEnemyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UEnemyCrowdSubsystem>() : nullptr)
+		{
+			Crowd->LogReport();
+		}
+	}));
+
+UEnemyCrowdSubsystem::UEnemyCrowdSubsystem() :
+	UpdateInterval(0.1f),
+	GridCellSize(200.f),
+	MaxAvoidingAgents(48),
+	AvoidanceDistance(3000.f),
+	NeighborRadius(200.f),
+	SeparationStrength(0.5f),
+	TimeSinceLastPass(0.f),
+	LastAvoiding(0),
+	LastSeparated(0),
+	LastOverBudget(0)
+{
+
+}
+
+void UEnemyCrowdSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	AgentGrid.SetCellSize(GridCellSize);
+}
+
+void UEnemyCrowdSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceLastPass += DeltaTime;
+	if (TimeSinceLastPass >= UpdateInterval)
+	{
+		TimeSinceLastPass = 0.f;
+		UpdateCrowd();
+	}
+
+	// Movement input is consumed every movement tick, so the separation is fed each frame
+	SCOPE_CYCLE_COUNTER(STAT_EnemyCrowdSeparation);
+	for (const FEnemyCrowdAgent& Agent : Agents)
+	{
+		if (Agent.bAvoiding || Agent.Separation.IsZero()) continue;
+
+		// Only moving enemies are separated, so idle ones do not start walking
+		AEnemy* Enemy{ Agent.Enemy.Get() };
+		if (Enemy && !Enemy->GetVelocity().IsNearlyZero())
+		{
+			Enemy->AddMovementInput(Agent.Separation);
+		}
+	}
+}
+
+bool UEnemyCrowdSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && Agents.Num() > 0;
+}
+
+TStatId UEnemyCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyCrowdSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	Agents.Add(Enemy);
+}
+
+void UEnemyCrowdSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	Agents.Remove(Enemy);
+}
+
+void UEnemyCrowdSubsystem::UpdateCrowd()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyCrowd);
+
+	FPlayerLocations PlayerLocations;
+	GetPlayerLocations(PlayerLocations);
+
+	AgentGrid.Reset();
+	AgentGrid.Reserve(Agents.Num());
+	for (int32 AgentIndex = 0; AgentIndex < Agents.Num(); AgentIndex++)
+	{
+		const AEnemy* Enemy{ Agents[AgentIndex].Enemy.Get() };
+		if (Enemy && !Enemy->IsDying())
+		{
+			AgentGrid.Add(Enemy->GetActorLocation(), AgentIndex);
+		}
+	}
+
+	// Enemies with neighbours near a player compete for crowd steering, nearest first
+	TArray<TPair<float, int32>> Candidates;
+	const float AvoidanceDistSquared{ FMath::Square(AvoidanceDistance) };
+	for (int32 GridIndex = 0; GridIndex < AgentGrid.Num(); GridIndex++)
+	{
+		const int32 AgentIndex{ AgentGrid.GetElement(GridIndex) };
+		const FVector& Location{ AgentGrid.GetLocation(GridIndex) };
+		FEnemyCrowdAgent& Agent{ Agents[AgentIndex] };
+
+		FVector Separation{ FVector::ZeroVector };
+		int32 NumNeighbors{ 0 };
+		AgentGrid.ForEachInRadius(Location, NeighborRadius,
+			[this, AgentIndex, &Location, &Separation, &NumNeighbors](int32 Index, int32 OtherAgentIndex, float DistSquared)
+		{
+			if (OtherAgentIndex == AgentIndex) return;
+
+			// Pushes harder the closer the neighbour is
+			const FVector Away{ (Location - AgentGrid.GetLocation(Index)).GetSafeNormal2D() };
+			Separation += Away * (1.f - FMath::Sqrt(DistSquared) / NeighborRadius);
+			NumNeighbors++;
+		});
+		Agent.Separation = Separation.GetClampedToMaxSize(1.f) * SeparationStrength;
+
+		if (NumNeighbors == 0) continue;
+
+		float NearestDistSquared{ TNumericLimits<float>::Max() };
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(Location, PlayerLocation));
+		}
+		if (NearestDistSquared <= AvoidanceDistSquared)
+		{
+			Candidates.Emplace(NearestDistSquared, AgentIndex);
+		}
+	}
+
+	if (Candidates.Num() > MaxAvoidingAgents)
+	{
+		Candidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+	}
+	LastOverBudget = FMath::Max(Candidates.Num() - MaxAvoidingAgents, 0);
+	Candidates.SetNum(FMath::Min(Candidates.Num(), MaxAvoidingAgents), false);
+
+	TBitArray<> ShouldAvoid(false, Agents.Num());
+	for (const TPair<float, int32>& Candidate : Candidates)
+	{
+		ShouldAvoid[Candidate.Value] = true;
+	}
+
+	LastAvoiding = 0;
+	LastSeparated = 0;
+	for (int32 AgentIndex = 0; AgentIndex < Agents.Num(); AgentIndex++)
+	{
+		FEnemyCrowdAgent& Agent{ Agents[AgentIndex] };
+		SetAgentAvoiding(Agent, ShouldAvoid[AgentIndex]);
+		if (Agent.bAvoiding)
+		{
+			LastAvoiding++;
+		}
+		else if (!Agent.Separation.IsZero())
+		{
+			LastSeparated++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CrowdAvoidingAgents, LastAvoiding);
+	SET_DWORD_STAT(STAT_CrowdSeparatedAgents, LastSeparated);
+	SET_DWORD_STAT(STAT_CrowdAgentsOverBudget, LastOverBudget);
+}
+
+void UEnemyCrowdSubsystem::SetAgentAvoiding(FEnemyCrowdAgent& Agent, bool bAvoiding) const
+{
+	if (Agent.bAvoiding == bAvoiding) return;
+
+	const AEnemy* Enemy{ Agent.Enemy.Get() };
+	const AEnemyController* EnemyController{ Enemy ? Enemy->GetEnemyController() : nullptr };
+	UCrowdFollowingComponent* CrowdFollowing{ EnemyController ? Cast<UCrowdFollowingComponent>(EnemyController->GetPathFollowingComponent()) : nullptr };
+	if (CrowdFollowing == nullptr) return;
+
+	// Suspended agents follow their path directly but are still avoided by the others
+	CrowdFollowing->SuspendCrowdSteering(!bAvoiding);
+	Agent.bAvoiding = bAvoiding;
+}
+
+void UEnemyCrowdSubsystem::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("%d enemies; last pass: %d avoiding (budget %d, %d over), %d separated"),
+		Agents.Num(),
+		LastAvoiding,
+		MaxAvoidingAgents,
+		LastOverBudget,
+		LastSeparated);
+}
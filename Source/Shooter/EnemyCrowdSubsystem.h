@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAgentSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashGrid.h"
+#include "EnemyCrowdSubsystem.generated.h"
+
+class AEnemy;
+
+/** An enemy whose crowd avoidance is managed by the crowd subsystem */
+struct FEnemyCrowdAgent
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+
+	/** True while the crowd manager steers the enemy; otherwise it follows its path and gets soft separation */
+	bool bAvoiding = true;
+
+	/** Movement input pushing the enemy away from its neighbours; refreshed each pass */
+	FVector Separation{ FVector::ZeroVector };
+};
+
+/**
+ * Splits enemies between full crowd avoidance and cheap separation. Each pass
+ * puts every enemy in a shared grid; the enemies nearest a player that have
+ * neighbours get detour crowd steering, up to a budget. All others have
+ * crowd steering suspended and, while moving, are pushed apart by soft forces
+ * from the grid.
+ *
+ * The grid only serves this subsystem's budget and separation queries. Every
+ * enemy stays registered with the detour crowd, which finds the neighbours
+ * of steered agents in its own proximity grid; UCrowdManager exposes no hook
+ * to feed those from here. Suspended agents are skipped by its steering and
+ * only appear as obstacles to the steered ones.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UEnemyCrowdSubsystem : public UEnemyAgentSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyCrowdSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called from AEnemy::BeginPlay */
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Called from AEnemy::EndPlay */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Logs how many enemies avoid and how many are separated */
+	void LogReport() const;
+
+private:
+	/** Rebuilds the grid, hands out the avoidance budget and computes separation */
+	void UpdateCrowd();
+
+	/** Turns crowd steering of Agent on or off */
+	void SetAgentAvoiding(FEnemyCrowdAgent& Agent, bool bAvoiding) const;
+
+	/** Seconds between passes */
+	UPROPERTY(Config)
+	float UpdateInterval;
+
+	/** Cell size of the enemy grid; close to NeighborRadius */
+	UPROPERTY(Config)
+	float GridCellSize;
+
+	/** Enemies steered by the crowd manager at once */
+	UPROPERTY(Config)
+	int32 MaxAvoidingAgents;
+
+	/** Enemies further than this from every player never use crowd steering */
+	UPROPERTY(Config)
+	float AvoidanceDistance;
+
+	/** Enemies closer than this are neighbours */
+	UPROPERTY(Config)
+	float NeighborRadius;
+
+	/** Movement input scale of the soft separation */
+	UPROPERTY(Config)
+	float SeparationStrength;
+
+	TEnemyAgentRegistry<FEnemyCrowdAgent> Agents;
+
+	/** Index into Agents of each enemy by location; rebuilt each pass */
+	TSpatialHashGrid<int32> AgentGrid;
+
+	float TimeSinceLastPass;
+
+	/** Counts from the last pass */
+	int32 LastAvoiding;
+	int32 LastSeparated;
+	int32 LastOverBudget;
+};
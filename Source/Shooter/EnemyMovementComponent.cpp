@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Movement Full"), STAT_EnemyMovementFull, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Enemy Movement Simplified"), STAT_EnemyMovementSimplified, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Movement Full Ticks"), STAT_EnemyMovementFullTicks, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Movement Simplified Ticks"), STAT_EnemyMovementSimplifiedTicks, STATGROUP_Shooter);
+
+namespace
+{
+	constexpr int32 NumMovementLODs{ static_cast<int32>(EEnemyMovementLOD::EEML_MAX) };
+
+	/** Movement tick time and count per level of detail since the last report; also kept without stats */
+	uint64 MovementCycles[NumMovementLODs];
+	uint32 MovementTicks[NumMovementLODs];
+}
+
+static FAutoConsoleCommand EnemyMovementReportCommand(
+	TEXT("Shooter.EnemyMovement.Report"),
+	TEXT("Logs the average enemy movement tick cost at each level of detail since the last report"),
+	FConsoleCommandDelegate::CreateStatic(&UEnemyMovementComponent::LogReport));
+
+void UEnemyMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	const int32 LOD{ static_cast<int32>(IsSimplified() ? EEnemyMovementLOD::EEML_Simplified : EEnemyMovementLOD::EEML_Full) };
+	const uint32 StartCycles{ FPlatformTime::Cycles() };
+
+	if (LOD == static_cast<int32>(EEnemyMovementLOD::EEML_Simplified))
+	{
+		SCOPE_CYCLE_COUNTER(STAT_EnemyMovementSimplified);
+		INC_DWORD_STAT(STAT_EnemyMovementSimplifiedTicks);
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	}
+	else
+	{
+		SCOPE_CYCLE_COUNTER(STAT_EnemyMovementFull);
+		INC_DWORD_STAT(STAT_EnemyMovementFullTicks);
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+		// Requested while falling or hit reacting; start once walking again
+		if (MovementLOD == EEnemyMovementLOD::EEML_Simplified && MovementMode == MOVE_Walking)
+		{
+			SetMovementMode(MOVE_NavWalking);
+		}
+	}
+
+	MovementCycles[LOD] += FPlatformTime::Cycles() - StartCycles;
+	MovementTicks[LOD]++;
+}
+
+void UEnemyMovementComponent::SetMovementLOD(EEnemyMovementLOD NewLOD)
+{
+	MovementLOD = NewLOD;
+
+	if (MovementLOD == EEnemyMovementLOD::EEML_Full && IsSimplified())
+	{
+		// Walking finds the floor again when it starts
+		SetMovementMode(MOVE_Walking);
+	}
+	else if (MovementLOD == EEnemyMovementLOD::EEML_Simplified && MovementMode == MOVE_Walking)
+	{
+		SetMovementMode(MOVE_NavWalking);
+	}
+}
+
+void UEnemyMovementComponent::LogReport()
+{
+	for (int32 LOD = 0; LOD < NumMovementLODs; LOD++)
+	{
+		const double Milliseconds{ FPlatformTime::ToMilliseconds64(MovementCycles[LOD]) };
+		UE_LOG(LogTemp, Log, TEXT("%s: %u ticks, %.3f us per enemy tick"),
+			LOD == static_cast<int32>(EEnemyMovementLOD::EEML_Simplified) ? TEXT("Simplified") : TEXT("Full"),
+			MovementTicks[LOD],
+			MovementTicks[LOD] > 0 ? Milliseconds * 1000.0 / MovementTicks[LOD] : 0.0);
+
+		MovementCycles[LOD] = 0;
+		MovementTicks[LOD] = 0;
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EnemyMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EEnemyMovementLOD : uint8
+{
+	/** Character movement walking, with floor sweeps and step ups */
+	EEML_Full UMETA(DisplayName = "Full"),
+	/** Engine nav walking: follows the navmesh without floor sweeps */
+	EEML_Simplified UMETA(DisplayName = "Simplified"),
+
+	EEML_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/**
+ * Character movement with a level of detail for distant enemies. The
+ * simplified level switches to MOVE_NavWalking, which moves along the navmesh
+ * without floor sweeps; the AI LOD subsystem picks the level and the tick
+ * interval per bucket.
+ */
+UCLASS()
+class SHOOTER_API UEnemyMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Simplified movement starts once the enemy is walking; full movement starts right away */
+	void SetMovementLOD(EEnemyMovementLOD NewLOD);
+
+	/** Logs the average movement tick cost per enemy at each level of detail since the last report */
+	static void LogReport();
+
+private:
+	FORCEINLINE bool IsSimplified() const { return MovementMode == MOVE_NavWalking; }
+
+	EEnemyMovementLOD MovementLOD = EEnemyMovementLOD::EEML_Full;
+
+public:
+	FORCEINLINE EEnemyMovementLOD GetMovementLOD() const { return MovementLOD; }
+};
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPerceptionSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Enemy.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Perception"), STAT_EnemyPerception, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Evaluations"), STAT_PerceptionEvaluations, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Traces"), STAT_PerceptionTraces, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Deferred Traces"), STAT_PerceptionDeferredTraces, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld PerceptionReportCommand(
+	TEXT("Shooter.Perception.Report"),
+	TEXT("Logs enemy perception evaluations and line of sight traces of the last pass"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UEnemyPerceptionSubsystem* Perception = World ? World->GetSubsystem<UEnemyPerceptionSubsystem>() : nullptr)
+		{
+			Perception->LogReport();
+		}
+	}));
+
+UEnemyPerceptionSubsystem::UEnemyPerceptionSubsystem() :
+	PerceptionTickInterval(0.1f),
+	GridCellSize(1000.f),
+	bRequireLineOfSight(false),
+	MaxLineOfSightTraces(32),
+	LineOfSightRetryDelay(0.5f),
+	FirstAgentIndex(0),
+	TimeSinceLastPass(0.f),
+	LastEvaluations(0),
+	LastTraces(0),
+	LastDeferredTraces(0)
+{
+
+}
+
+void UEnemyPerceptionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TargetGrid.SetCellSize(GridCellSize);
+}
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceLastPass += DeltaTime;
+	if (TimeSinceLastPass >= PerceptionTickInterval)
+	{
+		TimeSinceLastPass = 0.f;
+		UpdatePerception();
+	}
+}
+
+bool UEnemyPerceptionSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && Agents.Num() > 0;
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyPerceptionSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	Agents.Add(Enemy);
+}
+
+void UEnemyPerceptionSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	Agents.Remove(Enemy);
+}
+
+void UEnemyPerceptionSubsystem::UpdatePerception()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPerception);
+
+	UWorld* World{ GetWorld() };
+	TargetGrid.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (AShooterCharacter* Character = It->Get() ? Cast<AShooterCharacter>(It->Get()->GetPawn()) : nullptr)
+		{
+			TargetGrid.Add(Character->GetActorLocation(), Character);
+		}
+	}
+
+	const float CurrentTime{ World->GetTimeSeconds() };
+	const int32 NumAgents{ Agents.Num() };
+	int32 TracesLeft{ MaxLineOfSightTraces };
+	int32 FirstDeferredIndex{ INDEX_NONE };
+	LastEvaluations = 0;
+	LastDeferredTraces = 0;
+
+	for (int32 Count = 0; Count < NumAgents; ++Count)
+	{
+		const int32 AgentIndex{ (FirstAgentIndex + Count) % NumAgents };
+		FEnemyPerceptionAgent& Agent{ Agents[AgentIndex] };
+		AEnemy* Enemy{ Agent.Enemy.Get() };
+		if (Enemy == nullptr || Enemy->IsDying()) continue;
+		if (CurrentTime < Agent.NextEvaluationTime) continue;
+
+		const int32 DeferredBefore{ LastDeferredTraces };
+		EvaluateEnemy(Agent, Enemy, CurrentTime, TracesLeft);
+		LastEvaluations++;
+
+		if (LastDeferredTraces > DeferredBefore)
+		{
+			// Over the trace budget; retry on the next pass
+			if (FirstDeferredIndex == INDEX_NONE)
+			{
+				FirstDeferredIndex = AgentIndex;
+			}
+			continue;
+		}
+		Agent.NextEvaluationTime = CurrentTime + Enemy->GetPerceptionInterval();
+	}
+
+	// Deferred enemies go first next pass
+	FirstAgentIndex = FirstDeferredIndex != INDEX_NONE ? FirstDeferredIndex : 0;
+	LastTraces = MaxLineOfSightTraces - TracesLeft;
+
+	SET_DWORD_STAT(STAT_PerceptionEvaluations, LastEvaluations);
+	SET_DWORD_STAT(STAT_PerceptionTraces, LastTraces);
+	SET_DWORD_STAT(STAT_PerceptionDeferredTraces, LastDeferredTraces);
+}
+
+void UEnemyPerceptionSubsystem::EvaluateEnemy(FEnemyPerceptionAgent& Agent, AEnemy* Enemy, float CurrentTime, int32& TracesLeft)
+{
+	const float AgroRadius{ Enemy->GetAgroRadius() };
+	const float CombatRange{ Enemy->GetCombatRange() };
+
+	AShooterCharacter* NearestTarget{ nullptr };
+	float NearestDistSquared{ TNumericLimits<float>::Max() };
+	TargetGrid.ForEachInRadius(Enemy->GetActorLocation(), FMath::Max(AgroRadius, CombatRange),
+		[&NearestTarget, &NearestDistSquared](int32 Index, AShooterCharacter* Character, float DistSquared)
+	{
+		if (DistSquared < NearestDistSquared)
+		{
+			NearestTarget = Character;
+			NearestDistSquared = DistSquared;
+		}
+	});
+
+	Enemy->SetInAttackRange(NearestTarget && NearestDistSquared <= FMath::Square(CombatRange));
+
+	if (NearestTarget == nullptr || NearestDistSquared > FMath::Square(AgroRadius)) return;
+	if (Enemy->GetAgroTarget() == NearestTarget) return;
+
+	if (bRequireLineOfSight)
+	{
+		// A target behind a wall usually stays there for a while
+		if (CurrentTime < Agent.NextLineOfSightTime) return;
+
+		if (TracesLeft <= 0)
+		{
+			LastDeferredTraces++;
+			return;
+		}
+		TracesLeft--;
+		if (!HasLineOfSight(Enemy, NearestTarget))
+		{
+			Agent.NextLineOfSightTime = CurrentTime + LineOfSightRetryDelay;
+			return;
+		}
+	}
+
+	Enemy->SetAgroTarget(NearestTarget);
+}
+
+bool UEnemyPerceptionSubsystem::HasLineOfSight(const AEnemy* Enemy, const AShooterCharacter* Target) const
+{
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	Enemy->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(EnemyLineOfSight), false, Enemy);
+	QueryParams.AddIgnoredActor(Target);
+
+	// Only level geometry blocks sight, so the trace skips the dynamic actors crowding around the target
+	return !GetWorld()->LineTraceTestByObjectType(
+		EyeLocation,
+		Target->GetPawnViewLocation(),
+		FCollisionObjectQueryParams(ECC_WorldStatic),
+		QueryParams);
+}
+
+void UEnemyPerceptionSubsystem::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("%d enemies, %d targets; last pass: %d evaluations, %d line of sight traces, %d deferred"),
+		Agents.Num(),
+		TargetGrid.Num(),
+		LastEvaluations,
+		LastTraces,
+		LastDeferredTraces);
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAgentSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashGrid.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemy;
+class AShooterCharacter;
+
+/** An enemy evaluated by the perception subsystem */
+struct FEnemyPerceptionAgent
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+
+	/** World time of the next evaluation; spaced by the enemy's AI LOD perception interval */
+	float NextEvaluationTime = 0.f;
+
+	/** World time before which no line of sight is traced; pushed back after a blocked trace */
+	float NextLineOfSightTime = 0.f;
+};
+
+/**
+ * Decides aggro and attack range for every enemy in one batched pass per
+ * perception tick, replacing per-enemy overlap spheres. Players are put in a
+ * uniform grid each pass so an enemy only looks at the cells around it; line
+ * of sight to a new target is traced under a per-tick budget.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UEnemyPerceptionSubsystem : public UEnemyAgentSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyPerceptionSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called from AEnemy::BeginPlay */
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Called from AEnemy::EndPlay */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Rebuilds the target grid and evaluates every enemy that is due */
+	void UpdatePerception();
+
+	/** Logs the number of enemies, evaluations and line of sight traces of the last pass */
+	void LogReport() const;
+
+private:
+	/** Sets the target and attack range of one enemy from the targets around it */
+	void EvaluateEnemy(FEnemyPerceptionAgent& Agent, AEnemy* Enemy, float CurrentTime, int32& TracesLeft);
+
+	/** True if no static geometry is between Enemy's eyes and Target; other pawns and props do not block */
+	bool HasLineOfSight(const AEnemy* Enemy, const AShooterCharacter* Target) const;
+
+	/** Seconds between perception passes */
+	UPROPERTY(Config)
+	float PerceptionTickInterval;
+
+	/** Cell size of the target grid; close to the common agro radius */
+	UPROPERTY(Config)
+	float GridCellSize;
+
+	/** When true, an enemy only takes a target it can see */
+	UPROPERTY(Config)
+	bool bRequireLineOfSight;
+
+	/** Line of sight traces per pass; enemies over budget try again next pass */
+	UPROPERTY(Config)
+	int32 MaxLineOfSightTraces;
+
+	/** Seconds an enemy waits before tracing again after its line of sight was blocked */
+	UPROPERTY(Config)
+	float LineOfSightRetryDelay;
+
+	TEnemyAgentRegistry<FEnemyPerceptionAgent> Agents;
+
+	/** Player characters by location; rebuilt each pass */
+	TSpatialHashGrid<AShooterCharacter*> TargetGrid;
+
+	/** Agent the next pass starts at, so the trace budget is shared fairly */
+	int32 FirstAgentIndex;
+
+	float TimeSinceLastPass;
+
+	/** Counts from the last pass */
+	int32 LastEvaluations;
+	int32 LastTraces;
+	int32 LastDeferredTraces;
+};
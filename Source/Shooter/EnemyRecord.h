@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyRecord.generated.h"
+
+class AEnemy;
+
+/**
+ * An enemy far from every player, kept as data. The enemy virtualization
+ * subsystem advances it with a cheap patrol and chase simulation and
+ * materializes it from a pool of dormant actors when a player approaches.
+ */
+USTRUCT(BlueprintType)
+struct FEnemyRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TSubclassOf<AEnemy> EnemyClass;
+
+	/** Actor location, at capsule center */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Yaw = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Health = 0.f;
+
+	/** Patrol waypoints in world space, visited in order and looping */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FVector> PatrolRoute;
+
+	/** Index into PatrolRoute of the waypoint the patrol heads to */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PatrolIndex = 0;
+
+	/** Aggro target; the record walks straight toward it */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TWeakObjectPtr<AActor> Target;
+};
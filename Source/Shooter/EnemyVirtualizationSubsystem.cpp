@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyVirtualizationSubsystem.h"
+#include "Engine/World.h"
+#include "Components/CapsuleComponent.h"
+#include "NavigationSystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Enemy.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Virtualization"), STAT_EnemyVirtualization, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Records"), STAT_EnemyRecords, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Materialized Enemies"), STAT_MaterializedEnemies, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Materializations"), STAT_EnemyMaterializations, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Virtualizations"), STAT_EnemyVirtualizations, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld EnemyVirtualizationReportCommand(
+	TEXT("Shooter.EnemyVirtualization.Report"),
+	TEXT("Logs enemy records, materialized and dormant enemies"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UEnemyVirtualizationSubsystem* Virtualization = World ? World->GetSubsystem<UEnemyVirtualizationSubsystem>() : nullptr)
+		{
+			Virtualization->LogReport();
+		}
+	}));
+
+UEnemyVirtualizationSubsystem::UEnemyVirtualizationSubsystem() :
+	MaterializeDistance(6000.f),
+	VirtualizeDistance(8000.f),
+	EnemiesPerTick(128),
+	MaxMaterializationsPerTick(2),
+	MaxDormantPerClass(16),
+	RecordPatrolSpeed(150.f),
+	RecordChaseSpeed(300.f),
+	NextEnemyIndex(0),
+	bMaterializing(false),
+	Materializations(0),
+	Virtualizations(0),
+	FallbackSpawns(0)
+{
+
+}
+
+void UEnemyVirtualizationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyVirtualization);
+
+	UWorld* World{ GetWorld() };
+	FPlayerLocations PlayerLocations;
+	GetPlayerLocations(PlayerLocations);
+	if (PlayerLocations.Num() == 0) return;
+
+	const float CurrentTime{ World->GetTimeSeconds() };
+	const float MaterializeDistSquared{ FMath::Square(MaterializeDistance) };
+	int32 MaterializationsLeft{ MaxMaterializationsPerTick };
+
+	const int32 NumToCheck{ FMath::Min(EnemiesPerTick, Enemies.Num()) };
+	for (int32 Count = 0; Count < NumToCheck; ++Count)
+	{
+		NextEnemyIndex = NextEnemyIndex < Enemies.Num() ? NextEnemyIndex : 0;
+		const int32 Index{ NextEnemyIndex++ };
+		FVirtualizedEnemy& Entry{ Enemies[Index] };
+
+		if (const AEnemy* Enemy = Entry.Actor.Get())
+		{
+			if (ShouldVirtualize(Enemy, PlayerLocations))
+			{
+				Virtualize(Index);
+			}
+			continue;
+		}
+
+		SimulateRecord(Entry.Record, CurrentTime - Entry.LastSimulatedTime);
+		Entry.LastSimulatedTime = CurrentTime;
+
+		if (MaterializationsLeft <= 0) continue;
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			if (FVector::DistSquared(Entry.Record.Location, PlayerLocation) <= MaterializeDistSquared)
+			{
+				// A record that cannot be spawned here stays a record and is tried again later
+				Materialize(Index);
+				MaterializationsLeft--;
+				break;
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EnemyRecords, Enemies.Num() - EnemyIndices.Num());
+	SET_DWORD_STAT(STAT_MaterializedEnemies, EnemyIndices.Num());
+}
+
+bool UEnemyVirtualizationSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && Enemies.Num() > 0;
+}
+
+TStatId UEnemyVirtualizationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyVirtualizationSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyVirtualizationSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	// Materialize binds the enemy to its record itself
+	if (Enemy == nullptr || bMaterializing || EnemyIndices.Contains(Enemy)) return;
+
+	FVirtualizedEnemy Entry;
+	Entry.Actor = Enemy;
+	Enemy->SaveRecord(Entry.Record);
+	Entry.LastActorLocation = Entry.Record.Location;
+	EnemyIndices.Add(Enemy, Enemies.Add(Entry));
+}
+
+void UEnemyVirtualizationSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	int32 Index;
+	if (!EnemyIndices.RemoveAndCopyValue(Enemy, Index))
+	{
+		// Dormant enemies are not bound to a record
+		if (FEnemyPool* Pool = Pools.Find(Enemy->GetClass()))
+		{
+			Pool->DormantEnemies.RemoveSwap(Enemy);
+		}
+		return;
+	}
+
+	Enemies.RemoveAtSwap(Index);
+	if (Enemies.IsValidIndex(Index))
+	{
+		// The last enemy moved into the freed slot
+		if (const AEnemy* MovedEnemy = Enemies[Index].Actor.Get())
+		{
+			EnemyIndices.Add(MovedEnemy, Index);
+		}
+	}
+}
+
+void UEnemyVirtualizationSubsystem::Virtualize(int32 Index)
+{
+	FVirtualizedEnemy& Entry{ Enemies[Index] };
+	AEnemy* Enemy{ Entry.Actor.Get() };
+	if (Enemy == nullptr) return;
+
+	Enemy->SaveRecord(Entry.Record);
+	Entry.LastSimulatedTime = GetWorld()->GetTimeSeconds();
+	Entry.LastActorLocation = Entry.Record.Location;
+	Entry.Actor = nullptr;
+	EnemyIndices.Remove(Enemy);
+
+	ReleaseEnemy(Enemy);
+
+	Virtualizations++;
+	INC_DWORD_STAT(STAT_EnemyVirtualizations);
+}
+
+bool UEnemyVirtualizationSubsystem::Materialize(int32 Index)
+{
+	FVirtualizedEnemy& Entry{ Enemies[Index] };
+	FEnemyRecord& Record{ Entry.Record };
+
+	// The simulation ignores the navmesh; put the record back on it
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		const AEnemy* EnemyCDO{ Record.EnemyClass ? Record.EnemyClass->GetDefaultObject<AEnemy>() : nullptr };
+		const float HalfHeight{ EnemyCDO ? EnemyCDO->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() : 0.f };
+		const FVector ProjectionExtent{ 100.f, 100.f, 500.f };
+
+		// A record that walked off the navmesh, e.g. straight across a gap, goes back to where its actor last stood
+		FNavLocation NavLocation;
+		if (!NavSys->ProjectPointToNavigation(Record.Location, NavLocation, ProjectionExtent))
+		{
+			if (!NavSys->ProjectPointToNavigation(Entry.LastActorLocation, NavLocation, ProjectionExtent))
+			{
+				// Stays a record and is tried again later; the navmesh may not be built yet
+				return false;
+			}
+			// Walking straight toward the target is what took it off the navmesh
+			Record.Target = nullptr;
+		}
+		Record.Location = NavLocation.Location + FVector(0.f, 0.f, HalfHeight);
+	}
+
+	AEnemy* Enemy{ AcquireEnemy(Record.EnemyClass, FTransform(FRotator(0.f, Record.Yaw, 0.f), Record.Location)) };
+	if (Enemy == nullptr) return false;
+
+	Enemy->RestoreRecord(Record);
+	Enemy->SetDormant(false);
+
+	Enemies[Index].Actor = Enemy;
+	EnemyIndices.Add(Enemy, Index);
+
+	Materializations++;
+	INC_DWORD_STAT(STAT_EnemyMaterializations);
+	return true;
+}
+
+void UEnemyVirtualizationSubsystem::SimulateRecord(FEnemyRecord& Record, float DeltaTime) const
+{
+	const AActor* Target{ Record.Target.Get() };
+	const bool bPatrolling{ Target == nullptr && Record.PatrolRoute.IsValidIndex(Record.PatrolIndex) };
+	const FVector Goal{ bPatrolling ? Record.PatrolRoute[Record.PatrolIndex] : (Target ? Target->GetActorLocation() : Record.Location) };
+	const float Step{ (Target ? RecordChaseSpeed : RecordPatrolSpeed) * DeltaTime };
+
+	const FVector ToGoal{ Goal.X - Record.Location.X, Goal.Y - Record.Location.Y, 0.f };
+	const float Distance{ ToGoal.Size() };
+	if (Distance <= Step)
+	{
+		Record.Location.X = Goal.X;
+		Record.Location.Y = Goal.Y;
+		if (bPatrolling)
+		{
+			Record.PatrolIndex = (Record.PatrolIndex + 1) % Record.PatrolRoute.Num();
+		}
+		return;
+	}
+
+	Record.Location += ToGoal * (Step / Distance);
+	Record.Yaw = ToGoal.Rotation().Yaw;
+}
+
+bool UEnemyVirtualizationSubsystem::ShouldVirtualize(const AEnemy* Enemy, TArrayView<const FVector> PlayerLocations) const
+{
+	if (Enemy->IsDying() || Enemy->WasRecentlyRendered(1.f)) return false;
+
+	const float VirtualizeDistSquared{ FMath::Square(VirtualizeDistance) };
+	const FVector Location{ Enemy->GetActorLocation() };
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		if (FVector::DistSquared(Location, PlayerLocation) <= VirtualizeDistSquared)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+AEnemy* UEnemyVirtualizationSubsystem::AcquireEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform)
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	FEnemyPool* Pool{ Pools.Find(EnemyClass) };
+	while (Pool && Pool->DormantEnemies.Num() > 0)
+	{
+		AEnemy* Enemy{ Pool->DormantEnemies.Pop(false) };
+		if (IsValid(Enemy))
+		{
+			return Enemy;
+		}
+	}
+
+	// Pool is empty; spawn a new enemy. Its controller is spawned with it
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	TGuardValue<bool> MaterializingGuard(bMaterializing, true);
+	AEnemy* Enemy{ GetWorld()->SpawnActor<AEnemy>(EnemyClass, Transform, SpawnParams) };
+	if (Enemy)
+	{
+		FallbackSpawns++;
+	}
+	return Enemy;
+}
+
+void UEnemyVirtualizationSubsystem::ReleaseEnemy(AEnemy* Enemy)
+{
+	Enemy->SetDormant(true);
+
+	FEnemyPool& Pool{ Pools.FindOrAdd(Enemy->GetClass()) };
+	if (Pool.DormantEnemies.Num() < MaxDormantPerClass)
+	{
+		Pool.DormantEnemies.Add(Enemy);
+		return;
+	}
+	Enemy->Destroy();
+}
+
+void UEnemyVirtualizationSubsystem::LogReport() const
+{
+	int32 DormantEnemies{ 0 };
+	for (const auto& PoolPair : Pools)
+	{
+		DormantEnemies += PoolPair.Value.DormantEnemies.Num();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%d enemies: %d materialized, %d records, %d dormant actors; %d materializations (%d spawned), %d virtualizations"),
+		Enemies.Num(),
+		EnemyIndices.Num(),
+		Enemies.Num() - EnemyIndices.Num(),
+		DormantEnemies,
+		Materializations,
+		FallbackSpawns,
+		Virtualizations);
+}
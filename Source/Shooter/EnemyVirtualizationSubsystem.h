@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAgentSubsystem.h"
+#include "Tickable.h"
+#include "EnemyRecord.h"
+#include "EnemyVirtualizationSubsystem.generated.h"
+
+class AEnemy;
+
+/** An enemy tracked by the virtualization subsystem, as a record or as an actor */
+USTRUCT()
+struct FVirtualizedEnemy
+{
+	GENERATED_BODY()
+
+	/** Up to date while virtualized; refreshed from the actor when it is virtualized */
+	UPROPERTY()
+	FEnemyRecord Record;
+
+	/** The materialized enemy, or null while it only exists as its record */
+	TWeakObjectPtr<AEnemy> Actor;
+
+	/** World time the record was last simulated to */
+	float LastSimulatedTime = 0.f;
+
+	/** Where the actor last stood; the record falls back to it when it walked off the navmesh */
+	FVector LastActorLocation{ FVector::ZeroVector };
+};
+
+/** Dormant enemies of one class, ready to be materialized */
+USTRUCT()
+struct FEnemyPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AEnemy*> DormantEnemies;
+};
+
+/**
+ * Keeps enemies far from every player as records instead of actors. Records
+ * walk their patrol, or straight toward their target, in a cheap simulation;
+ * when a player approaches they are materialized from a pool of dormant
+ * enemies. Enemies that leave the player's range and view go back to records
+ * and their actors to the pool, so a level costs mostly its active enemies.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UEnemyVirtualizationSubsystem : public UEnemyAgentSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyVirtualizationSubsystem();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called from AEnemy::BeginPlay; enemies placed in the level start materialized */
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Called from AEnemy::EndPlay; a dying enemy's record goes with it */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Logs records, active and dormant enemies and the materialization counters */
+	void LogReport() const;
+
+private:
+	/** Turns the enemy at Index into its record and returns its actor to the pool */
+	void Virtualize(int32 Index);
+
+	/** Places a pooled or new actor for the record at Index. False if no actor could be spawned or placed on the navmesh */
+	bool Materialize(int32 Index);
+
+	/** Advances a record along its patrol or toward its target */
+	void SimulateRecord(FEnemyRecord& Record, float DeltaTime) const;
+
+	/** True if Enemy can become a record: out of range and view of every player and not dying */
+	bool ShouldVirtualize(const AEnemy* Enemy, TArrayView<const FVector> PlayerLocations) const;
+
+	/** Takes a dormant enemy of EnemyClass from the pool, or spawns one */
+	AEnemy* AcquireEnemy(TSubclassOf<AEnemy> EnemyClass, const FTransform& Transform);
+
+	/** Makes Enemy dormant and pools it, or destroys it when the pool is full */
+	void ReleaseEnemy(AEnemy* Enemy);
+
+	/** Records within this distance of a player are materialized */
+	UPROPERTY(Config)
+	float MaterializeDistance;
+
+	/** Enemies beyond this distance of every player are virtualized; larger than MaterializeDistance */
+	UPROPERTY(Config)
+	float VirtualizeDistance;
+
+	/** Enemies and records checked per frame */
+	UPROPERTY(Config)
+	int32 EnemiesPerTick;
+
+	/** Actors materialized per frame */
+	UPROPERTY(Config)
+	int32 MaxMaterializationsPerTick;
+
+	/** Dormant enemies kept per class; more are destroyed */
+	UPROPERTY(Config)
+	int32 MaxDormantPerClass;
+
+	/** Speed of records patrolling */
+	UPROPERTY(Config)
+	float RecordPatrolSpeed;
+
+	/** Speed of records walking toward their target */
+	UPROPERTY(Config)
+	float RecordChaseSpeed;
+
+	UPROPERTY()
+	TArray<FVirtualizedEnemy> Enemies;
+
+	/** Index into Enemies of each materialized enemy */
+	TMap<const AEnemy*, int32> EnemyIndices;
+
+	/** Dormant enemies, by class */
+	UPROPERTY()
+	TMap<UClass*, FEnemyPool> Pools;
+
+	/** Next enemy to check */
+	int32 NextEnemyIndex;
+
+	/** Set while an actor is spawned for a record, so its BeginPlay does not add another record */
+	bool bMaterializing;
+
+	int32 Materializations;
+	int32 Virtualizations;
+	int32 FallbackSpawns;
+};
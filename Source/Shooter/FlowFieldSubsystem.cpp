@@ -0,0 +1,511 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlowFieldSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "HAL/IConsoleManager.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Build"), STAT_FlowFieldBuild, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Flow Field Chasers"), STAT_FlowFieldChasers, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Fields"), STAT_FlowFields, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Chasers"), STAT_FlowFieldChaserCount, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld FlowFieldReportCommand(
+	TEXT("Shooter.FlowField.Report"),
+	TEXT("Logs flow fields, their chasers and the cached cell heights"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UFlowFieldSubsystem* FlowFields = World ? World->GetSubsystem<UFlowFieldSubsystem>() : nullptr)
+		{
+			FlowFields->LogReport();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs FlowFieldBenchmarkCommand(
+	TEXT("Shooter.FlowField.Benchmark"),
+	TEXT("Times per-agent navmesh paths against one flow field toward the player. Args: agent counts (default 100 300 1000)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UFlowFieldSubsystem* FlowFields{ World ? World->GetSubsystem<UFlowFieldSubsystem>() : nullptr };
+		if (FlowFields == nullptr) return;
+
+		TArray<int32> AgentCounts;
+		for (const FString& Arg : Args)
+		{
+			AgentCounts.Add(FCString::Atoi(*Arg));
+		}
+		if (AgentCounts.Num() == 0)
+		{
+			AgentCounts = { 100, 300, 1000 };
+		}
+		FlowFields->RunBenchmark(AgentCounts);
+	}));
+
+namespace
+{
+	const FIntPoint NeighborOffsets[] = {
+		{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+		{ 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+	/** The build expands through the first four; sampling also looks at the diagonals */
+	constexpr int32 NumOrthogonalNeighbors{ 4 };
+	static_assert(UE_ARRAY_COUNT(NeighborOffsets) <= 8, "CellLinks keeps one bit per neighbour in a byte");
+}
+
+UFlowFieldSubsystem::UFlowFieldSubsystem() :
+	CellSize(100.f),
+	GridHalfExtent(48),
+	CellsPerTick(4096),
+	MaxStepHeight(60.f),
+	ProjectionHalfHeight(200.f),
+	FieldLifetime(5.f)
+{
+
+}
+
+bool UFlowFieldSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World{ Cast<UWorld>(Outer) };
+	return World && World->IsGameWorld();
+}
+
+void UFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Cell heights are stale once the navmesh is rebuilt
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &UFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+}
+
+void UFlowFieldSubsystem::Deinitialize()
+{
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &UFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+	Fields.Empty();
+	Chasers.Empty();
+	CellHeights.Empty();
+	CellLinks.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	const float CurrentTime{ GetWorld()->GetTimeSeconds() };
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlowFieldBuild);
+
+		// Fields of gone targets, or that nobody samples, expire
+		Fields.RemoveAllSwap([CurrentTime, this](const FFlowField& Field)
+		{
+			return !Field.Target.IsValid() || CurrentTime - Field.LastSampleTime > FieldLifetime;
+		});
+
+		int32 CellBudget{ CellsPerTick };
+		for (FFlowField& Field : Fields)
+		{
+			if (!Field.bBuilding && (!Field.bValid || ToCell(Field.Target->GetActorLocation()) != Field.TargetCell))
+			{
+				StartBuild(Field);
+			}
+			if (Field.bBuilding && CellBudget > 0)
+			{
+				CellBudget -= ContinueBuild(Field, CellBudget);
+			}
+		}
+	}
+
+	UpdateChasers();
+
+	SET_DWORD_STAT(STAT_FlowFields, Fields.Num());
+	SET_DWORD_STAT(STAT_FlowFieldChaserCount, Chasers.Num());
+}
+
+bool UFlowFieldSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && (Fields.Num() > 0 || Chasers.Num() > 0);
+}
+
+TStatId UFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UFlowFieldSubsystem::StartChase(AAIController* Controller, AActor* Target, float AcceptanceRadius)
+{
+	if (Controller == nullptr || Target == nullptr) return;
+
+	StopChase(Controller);
+
+	FFlowFieldChaser Chaser;
+	Chaser.Controller = Controller;
+	Chaser.Target = Target;
+	Chaser.AcceptanceRadius = AcceptanceRadius;
+	Chasers.Add(Chaser);
+}
+
+void UFlowFieldSubsystem::StopChase(AAIController* Controller)
+{
+	const int32 ChaserIndex{ Chasers.IndexOfByPredicate([Controller](const FFlowFieldChaser& Chaser)
+	{
+		return Chaser.Controller == Controller;
+	}) };
+	if (ChaserIndex == INDEX_NONE) return;
+
+	if (Chasers[ChaserIndex].bUsingNavPath && Controller)
+	{
+		Controller->StopMovement();
+	}
+	Chasers.RemoveAtSwap(ChaserIndex);
+}
+
+bool UFlowFieldSubsystem::GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection)
+{
+	if (Target == nullptr) return false;
+
+	FFlowField& Field{ FindOrAddField(Target) };
+	Field.LastSampleTime = GetWorld()->GetTimeSeconds();
+	return SampleFlowDirection(Field, Location, OutDirection);
+}
+
+bool UFlowFieldSubsystem::SampleFlowDirection(const FFlowField& Field, const FVector& Location, FVector& OutDirection) const
+{
+	const AActor* Target{ Field.Target.Get() };
+	if (!Field.bValid || Target == nullptr) return false;
+
+	const int32 GridSize{ GetGridSize() };
+	const FIntPoint Cell{ ToCell(Location) };
+	const FIntPoint LocalCell{ Cell - Field.Origin };
+	if (LocalCell.X < 0 || LocalCell.Y < 0 || LocalCell.X >= GridSize || LocalCell.Y >= GridSize) return false;
+
+	auto GetCost = [&Field, GridSize](const FIntPoint& Local)
+	{
+		const bool bInside{ Local.X >= 0 && Local.Y >= 0 && Local.X < GridSize && Local.Y < GridSize };
+		return bInside ? Field.Costs[Local.Y * GridSize + Local.X] : MAX_uint16;
+	};
+
+	const uint16 Cost{ GetCost(LocalCell) };
+	if (Cost == MAX_uint16) return false;
+
+	// In the target's cell; head straight for it
+	if (Cost == 0)
+	{
+		OutDirection = (Target->GetActorLocation() - Location).GetSafeNormal2D();
+		return true;
+	}
+
+	FIntPoint BestCell{ Cell };
+	uint16 BestCost{ Cost };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(NeighborOffsets); i++)
+	{
+		const FIntPoint& Offset{ NeighborOffsets[i] };
+
+		// The build only links orthogonal cells; a diagonal step could cut a corner of a wall
+		if (i >= NumOrthogonalNeighbors &&
+			(GetCost(LocalCell + FIntPoint(Offset.X, 0)) == MAX_uint16 || GetCost(LocalCell + FIntPoint(0, Offset.Y)) == MAX_uint16))
+		{
+			continue;
+		}
+
+		const uint16 NeighborCost{ GetCost(LocalCell + Offset) };
+		if (NeighborCost < BestCost)
+		{
+			BestCost = NeighborCost;
+			BestCell = Cell + Offset;
+		}
+	}
+
+	OutDirection = (GetCellCenter(BestCell) - Location).GetSafeNormal2D();
+	return !OutDirection.IsNearlyZero();
+}
+
+FFlowField& UFlowFieldSubsystem::FindOrAddField(AActor* Target)
+{
+	for (FFlowField& Field : Fields)
+	{
+		if (Field.Target == Target)
+		{
+			return Field;
+		}
+	}
+
+	FFlowField& Field{ Fields.AddDefaulted_GetRef() };
+	Field.Target = Target;
+	Field.LastSampleTime = GetWorld()->GetTimeSeconds();
+	return Field;
+}
+
+void UFlowFieldSubsystem::StartBuild(FFlowField& Field)
+{
+	const FVector TargetLocation{ Field.Target->GetActorLocation() };
+	const int32 GridSize{ GetGridSize() };
+	const int32 NumCells{ GridSize * GridSize };
+
+	Field.BuildTargetCell = ToCell(TargetLocation);
+	Field.BuildOrigin = Field.BuildTargetCell - FIntPoint(GridHalfExtent, GridHalfExtent);
+	Field.BuildCosts.Init(MAX_uint16, NumCells);
+	Field.BuildHeights.SetNumUninitialized(NumCells);
+	Field.BuildQueue.Reset(NumCells);
+	Field.BuildQueueHead = 0;
+	Field.bBuilding = true;
+
+	// The target may be airborne; seed from the navmesh below it when there is some
+	const float TargetCellHeight{ GetCellHeight(Field.BuildTargetCell, TargetLocation.Z) };
+	const int32 TargetIndex{ GridHalfExtent * GridSize + GridHalfExtent };
+	Field.BuildCosts[TargetIndex] = 0;
+	Field.BuildHeights[TargetIndex] = TargetCellHeight != MAX_flt ? TargetCellHeight : TargetLocation.Z;
+	Field.BuildQueue.Add(TargetIndex);
+}
+
+int32 UFlowFieldSubsystem::ContinueBuild(FFlowField& Field, int32 CellBudget)
+{
+	UNavigationSystemV1* NavSys{ FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()) };
+	const ANavigationData* NavData{ NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr };
+	// Stays building until a navmesh is generated
+	if (NavData == nullptr) return 0;
+
+	const int32 GridSize{ GetGridSize() };
+	int32 CellsExpanded{ 0 };
+
+	// Breadth-first from the target; the queue survives across frames
+	while (Field.BuildQueueHead < Field.BuildQueue.Num() && CellsExpanded < CellBudget)
+	{
+		const int32 Index{ Field.BuildQueue[Field.BuildQueueHead++] };
+		const FIntPoint LocalCell{ Index % GridSize, Index / GridSize };
+		const uint16 Cost{ Field.BuildCosts[Index] };
+		const float Height{ Field.BuildHeights[Index] };
+		CellsExpanded++;
+
+		for (int32 i = 0; i < NumOrthogonalNeighbors; i++)
+		{
+			const FIntPoint Neighbor{ LocalCell + NeighborOffsets[i] };
+			if (Neighbor.X < 0 || Neighbor.Y < 0 || Neighbor.X >= GridSize || Neighbor.Y >= GridSize) continue;
+
+			const int32 NeighborIndex{ Neighbor.Y * GridSize + Neighbor.X };
+			if (Field.BuildCosts[NeighborIndex] != MAX_uint16) continue;
+
+			// The height check is cheap and rules out most ledges before the raycast
+			const float NeighborHeight{ GetCellHeight(Field.BuildOrigin + Neighbor, Height) };
+			if (NeighborHeight == MAX_flt || FMath::Abs(NeighborHeight - Height) > MaxStepHeight) continue;
+			if (!AreCellsLinked(*NavData, Field.BuildOrigin + LocalCell, Height, i, NeighborHeight)) continue;
+
+			Field.BuildCosts[NeighborIndex] = Cost + 1;
+			Field.BuildHeights[NeighborIndex] = NeighborHeight;
+			Field.BuildQueue.Add(NeighborIndex);
+		}
+	}
+
+	if (Field.BuildQueueHead >= Field.BuildQueue.Num())
+	{
+		// Swap in the finished field; the old arrays are reused by the next build
+		Swap(Field.Costs, Field.BuildCosts);
+		Field.Origin = Field.BuildOrigin;
+		Field.TargetCell = Field.BuildTargetCell;
+		Field.bValid = true;
+		Field.bBuilding = false;
+	}
+	return CellsExpanded;
+}
+
+void UFlowFieldSubsystem::UpdateChasers()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldChasers);
+
+	for (int32 ChaserIndex = Chasers.Num() - 1; ChaserIndex >= 0; --ChaserIndex)
+	{
+		FFlowFieldChaser& Chaser{ Chasers[ChaserIndex] };
+		AAIController* Controller{ Chaser.Controller.Get() };
+		APawn* Pawn{ Controller ? Controller->GetPawn() : nullptr };
+		AActor* Target{ Chaser.Target.Get() };
+		if (Pawn == nullptr || Target == nullptr)
+		{
+			Chasers.RemoveAtSwap(ChaserIndex);
+			continue;
+		}
+
+		const FVector PawnLocation{ Pawn->GetActorLocation() };
+		if (FVector::DistSquared2D(PawnLocation, Target->GetActorLocation()) <= FMath::Square(Chaser.AcceptanceRadius)) continue;
+
+		FVector Direction;
+		if (GetFlowDirection(Target, PawnLocation, Direction))
+		{
+			if (Chaser.bUsingNavPath)
+			{
+				Controller->StopMovement();
+				Chaser.bUsingNavPath = false;
+			}
+			Pawn->AddMovementInput(Direction);
+		}
+		else if (!Chaser.bUsingNavPath)
+		{
+			// Outside the field; path in until it can be sampled
+			Controller->MoveToActor(Target, Chaser.AcceptanceRadius);
+			Chaser.bUsingNavPath = true;
+		}
+	}
+}
+
+float UFlowFieldSubsystem::GetCellHeight(const FIntPoint& Cell, float ReferenceZ)
+{
+	const FIntVector Key{ Cell.X, Cell.Y, FMath::FloorToInt(ReferenceZ / (ProjectionHalfHeight * 2.f)) };
+	if (const float* CachedHeight = CellHeights.Find(Key))
+	{
+		return *CachedHeight;
+	}
+
+	float Height{ MAX_flt };
+	UNavigationSystemV1* NavSys{ FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()) };
+	FNavLocation NavLocation;
+	const FVector CellCenter{ GetCellCenter(Cell) + FVector(0.f, 0.f, ReferenceZ) };
+	if (NavSys && NavSys->ProjectPointToNavigation(CellCenter, NavLocation, FVector(CellSize * 0.5f, CellSize * 0.5f, ProjectionHalfHeight)))
+	{
+		Height = NavLocation.Location.Z;
+	}
+
+	CellHeights.Add(Key, Height);
+	return Height;
+}
+
+bool UFlowFieldSubsystem::AreCellsLinked(const ANavigationData& NavData, const FIntPoint& Cell, float Height, int32 Direction, float NeighborHeight)
+{
+	const FIntVector Key{ Cell.X, Cell.Y, FMath::FloorToInt(Height / (ProjectionHalfHeight * 2.f)) };
+	uint16& Links{ CellLinks.FindOrAdd(Key) };
+	const uint16 TracedBit{ (uint16)(1 << Direction) };
+	const uint16 LinkedBit{ (uint16)(1 << (Direction + 8)) };
+
+	if ((Links & TracedBit) == 0)
+	{
+		// Walls, gaps and thin obstacles between the two cell centers cut the navmesh even when the heights match
+		const FVector Start{ GetCellCenter(Cell) + FVector(0.f, 0.f, Height) };
+		const FVector End{ GetCellCenter(Cell + NeighborOffsets[Direction]) + FVector(0.f, 0.f, NeighborHeight) };
+		FVector HitLocation;
+		const bool bBlocked{ NavData.Raycast(Start, End, HitLocation, NavData.GetDefaultQueryFilter(), this) };
+		Links |= TracedBit | (bBlocked ? 0 : LinkedBit);
+	}
+	return (Links & LinkedBit) != 0;
+}
+
+void UFlowFieldSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	CellHeights.Reset();
+	CellLinks.Reset();
+	for (FFlowField& Field : Fields)
+	{
+		Field.bBuilding = false;
+		Field.bValid = false;
+	}
+}
+
+void UFlowFieldSubsystem::RunBenchmark(TArrayView<const int32> AgentCounts)
+{
+	UWorld* World{ GetWorld() };
+	APlayerController* PlayerController{ World->GetFirstPlayerController() };
+	APawn* Player{ PlayerController ? PlayerController->GetPawn() : nullptr };
+	UNavigationSystemV1* NavSys{ FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) };
+	ANavigationData* NavData{ NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr };
+	if (Player == nullptr || NavData == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Flow field benchmark needs a player pawn and a navmesh"));
+		return;
+	}
+
+	const FVector PlayerLocation{ Player->GetActorLocation() };
+	const float SpawnRadius{ GridHalfExtent * CellSize };
+
+	// Chasers keep sampling the live fields and caches; the benchmark builds its own and puts them back after
+	TMap<FIntVector, float> LiveCellHeights{ MoveTemp(CellHeights) };
+	TMap<FIntVector, uint16> LiveCellLinks{ MoveTemp(CellLinks) };
+	CellHeights.Reset();
+	CellLinks.Reset();
+
+	for (const int32 AgentCount : AgentCounts)
+	{
+		TArray<FVector> AgentLocations;
+		AgentLocations.Reserve(AgentCount);
+		for (int32 i = 0; i < AgentCount; i++)
+		{
+			FNavLocation NavLocation;
+			if (NavSys->GetRandomReachablePointInRadius(PlayerLocation, SpawnRadius, NavLocation))
+			{
+				AgentLocations.Add(NavLocation.Location);
+			}
+		}
+
+		// One navmesh path per agent, as each MoveTo does
+		double StartTime{ FPlatformTime::Seconds() };
+		int32 NumPaths{ 0 };
+		for (const FVector& AgentLocation : AgentLocations)
+		{
+			const FPathFindingQuery Query(this, *NavData, AgentLocation, PlayerLocation);
+			NumPaths += NavSys->FindPathSync(Query).IsSuccessful() ? 1 : 0;
+		}
+		const double PerAgentMs{ (FPlatformTime::Seconds() - StartTime) * 1000.0 };
+
+		// One cold field for the target, then one sample per agent
+		CellHeights.Reset();
+		CellLinks.Reset();
+		FFlowField Field;
+		Field.Target = Player;
+		StartTime = FPlatformTime::Seconds();
+		StartBuild(Field);
+		ContinueBuild(Field, MAX_int32);
+		int32 NumSampled{ 0 };
+		for (const FVector& AgentLocation : AgentLocations)
+		{
+			FVector Direction;
+			NumSampled += SampleFlowDirection(Field, AgentLocation, Direction) ? 1 : 0;
+		}
+		const double FlowFieldMs{ (FPlatformTime::Seconds() - StartTime) * 1000.0 };
+
+		// Rebuild with the cell heights and links cached, as when the target moves
+		StartTime = FPlatformTime::Seconds();
+		StartBuild(Field);
+		ContinueBuild(Field, MAX_int32);
+		for (const FVector& AgentLocation : AgentLocations)
+		{
+			FVector Direction;
+			SampleFlowDirection(Field, AgentLocation, Direction);
+		}
+		const double WarmFlowFieldMs{ (FPlatformTime::Seconds() - StartTime) * 1000.0 };
+
+		UE_LOG(LogTemp, Log, TEXT("%d agents: per-agent paths %.2f ms (%d found), flow field %.2f ms cold / %.2f ms warm (%d in field)"),
+			AgentLocations.Num(),
+			PerAgentMs,
+			NumPaths,
+			FlowFieldMs,
+			WarmFlowFieldMs,
+			NumSampled);
+	}
+
+	CellHeights = MoveTemp(LiveCellHeights);
+	CellLinks = MoveTemp(LiveCellLinks);
+}
+
+void UFlowFieldSubsystem::LogReport() const
+{
+	for (const FFlowField& Field : Fields)
+	{
+		const int32 NumChasers{ Chasers.FilterByPredicate([&Field](const FFlowFieldChaser& Chaser)
+		{
+			return Chaser.Target == Field.Target;
+		}).Num() };
+		UE_LOG(LogTemp, Log, TEXT("%s: %d chasers, %s%s"),
+			*GetNameSafe(Field.Target.Get()),
+			NumChasers,
+			Field.bValid ? TEXT("valid") : TEXT("not built"),
+			Field.bBuilding ? TEXT(", rebuilding") : TEXT(""));
+	}
+	UE_LOG(LogTemp, Log, TEXT("%d flow fields, %d chasers, %d cached cell heights"), Fields.Num(), Chasers.Num(), CellHeights.Num());
+}
@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FlowFieldSubsystem.generated.h"
+
+class AAIController;
+class ANavigationData;
+
+/**
+ * Steps to one target over a coarse grid of navmesh-projected cells, centered
+ * on the target. The next field is built across frames while chasers keep
+ * sampling the last finished one.
+ */
+struct FFlowField
+{
+	TWeakObjectPtr<AActor> Target;
+
+	/** Finished field: grid minimum corner and target cell, in cell coordinates */
+	FIntPoint Origin{ 0, 0 };
+	FIntPoint TargetCell{ 0, 0 };
+
+	/** Steps to the target for each cell; MAX_uint16 when unreachable */
+	TArray<uint16> Costs;
+
+	bool bValid = false;
+
+	/** Field being built */
+	FIntPoint BuildOrigin{ 0, 0 };
+	FIntPoint BuildTargetCell{ 0, 0 };
+	TArray<uint16> BuildCosts;
+	/** Navmesh height of each reached cell */
+	TArray<float> BuildHeights;
+	TArray<int32> BuildQueue;
+	int32 BuildQueueHead = 0;
+	bool bBuilding = false;
+
+	/** Fields nobody samples expire */
+	float LastSampleTime = 0.f;
+};
+
+/** An AI controller moved along a flow field */
+struct FFlowFieldChaser
+{
+	TWeakObjectPtr<AAIController> Controller;
+	TWeakObjectPtr<AActor> Target;
+	float AcceptanceRadius = 0.f;
+
+	/** True while the chaser is outside the field and uses a navmesh path instead */
+	bool bUsingNavPath = false;
+};
+
+/**
+ * Flow-field pathing for many enemies chasing the same target. One field is
+ * kept per target and rebuilt, time-sliced, when the target changes cell; every
+ * chaser samples it, so the pathing cost does not grow with the number of
+ * chasers. Chasers outside the field fall back to a navmesh path.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UFlowFieldSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UFlowFieldSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Moves Controller's pawn toward Target every frame until StopChase */
+	void StartChase(AAIController* Controller, AActor* Target, float AcceptanceRadius);
+	void StopChase(AAIController* Controller);
+
+	/** Direction to move from Location toward Target. False when Location is outside Target's field or cut off from it */
+	bool GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection);
+
+	/** Logs per-agent navmesh pathing against a flow field for each count of agents around the first player */
+	void RunBenchmark(TArrayView<const int32> AgentCounts);
+
+	void LogReport() const;
+
+private:
+	FFlowField& FindOrAddField(AActor* Target);
+
+	/** Direction to move from Location along the finished Field; false outside it or when cut off */
+	bool SampleFlowDirection(const FFlowField& Field, const FVector& Location, FVector& OutDirection) const;
+
+	/** Starts building Field around its target's current cell */
+	void StartBuild(FFlowField& Field);
+
+	/** Expands the build of Field by up to CellBudget cells; finishes it when done. Returns the cells used */
+	int32 ContinueBuild(FFlowField& Field, int32 CellBudget);
+
+	/** Moves every chaser along its field */
+	void UpdateChasers();
+
+	/** Navmesh height of Cell near ReferenceZ, or MAX_flt if it has no navmesh */
+	float GetCellHeight(const FIntPoint& Cell, float ReferenceZ);
+
+	/**
+	 * True if a navmesh raycast gets from Cell at Height to its neighbour NeighborOffsets[Direction]
+	 * at NeighborHeight without leaving the navmesh
+	 */
+	bool AreCellsLinked(const ANavigationData& NavData, const FIntPoint& Cell, float Height, int32 Direction, float NeighborHeight);
+
+	FORCEINLINE FIntPoint ToCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	FORCEINLINE FVector GetCellCenter(const FIntPoint& Cell) const
+	{
+		return FVector((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, 0.f);
+	}
+
+	FORCEINLINE int32 GetGridSize() const { return GridHalfExtent * 2 + 1; }
+
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	/** Width of a grid cell */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/** Cells from the target to the edge of its field */
+	UPROPERTY(Config)
+	int32 GridHalfExtent;
+
+	/** Cells expanded per frame over all fields being built */
+	UPROPERTY(Config)
+	int32 CellsPerTick;
+
+	/** Largest height difference between neighbouring cells that is still walkable */
+	UPROPERTY(Config)
+	float MaxStepHeight;
+
+	/** How far above and below the target cells are projected onto the navmesh */
+	UPROPERTY(Config)
+	float ProjectionHalfHeight;
+
+	/** Seconds a field is kept after it was last sampled */
+	UPROPERTY(Config)
+	float FieldLifetime;
+
+	TArray<FFlowField> Fields;
+
+	TArray<FFlowFieldChaser> Chasers;
+
+	/** Navmesh height per cell and height band; MAX_flt when the cell has no navmesh */
+	TMap<FIntVector, float> CellHeights;
+
+	/**
+	 * Navmesh raycast results per cell and height band, keyed like CellHeights. Bit N is set once
+	 * the link toward NeighborOffsets[N] was traced, and bit N + 8 when the raycast got through.
+	 */
+	TMap<FIntVector, uint16> CellLinks;
+};
@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GruxDecisionSubsystem.h"
+#include "Engine/World.h"
+#include "BrainComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Enemy.h"
+#include "EnemyController.h"
+#include "FlowFieldSubsystem.h"
+#include "PathCacheSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Grux Decisions"), STAT_GruxDecisions, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Grux Decisions"), STAT_GruxDecisionCount, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld GruxReportCommand(
+	TEXT("Shooter.Grux.Report"),
+	TEXT("Logs the number of Grux in each decision state"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGruxDecisionSubsystem* Decisions = World ? World->GetSubsystem<UGruxDecisionSubsystem>() : nullptr)
+		{
+			Decisions->LogReport();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GruxNativeDecisionsCommand(
+	TEXT("Shooter.Grux.NativeDecisions"),
+	TEXT("1: Grux decide in the native decision core. 0: Grux run their behavior tree"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGruxDecisionSubsystem* Decisions{ World ? World->GetSubsystem<UGruxDecisionSubsystem>() : nullptr };
+		if (Decisions == nullptr) return;
+
+		if (Args.Num() > 0)
+		{
+			Decisions->SetUseNativeDecisions(FCString::Atoi(*Args[0]) != 0);
+		}
+		UE_LOG(LogTemp, Log, TEXT("Grux native decisions: %s"), Decisions->UsesNativeDecisions() ? TEXT("on") : TEXT("off"));
+	}));
+
+UGruxDecisionSubsystem::UGruxDecisionSubsystem() :
+	bUseNativeDecisions(false),
+	AgentsPerTick(64),
+	PatrolAcceptanceRadius(50.f),
+	ChaseAcceptanceRadius(50.f),
+	CircleRadius(300.f),
+	CircleStepAngle(30.f),
+	NextAgentIndex(0),
+	LastDecisions(0)
+{
+
+}
+
+void UGruxDecisionSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GruxDecisions);
+
+	const float CurrentTime{ GetWorld()->GetTimeSeconds() };
+	const int32 NumToCheck{ FMath::Min(AgentsPerTick, Agents.Num()) };
+	LastDecisions = 0;
+
+	for (int32 Count = 0; Count < NumToCheck; ++Count)
+	{
+		NextAgentIndex = NextAgentIndex < Agents.Num() ? NextAgentIndex : 0;
+		FGruxAgent& Agent{ Agents[NextAgentIndex++] };
+		AEnemy* Enemy{ Agent.Enemy.Get() };
+		if (Enemy == nullptr || CurrentTime < Agent.NextDecisionTime) continue;
+
+		Decide(Agent, *Enemy);
+		Agent.NextDecisionTime = CurrentTime + Enemy->GetDecisionInterval();
+		LastDecisions++;
+	}
+
+	SET_DWORD_STAT(STAT_GruxDecisionCount, LastDecisions);
+}
+
+bool UGruxDecisionSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && bUseNativeDecisions && Agents.Num() > 0;
+}
+
+TStatId UGruxDecisionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGruxDecisionSubsystem, STATGROUP_Tickables);
+}
+
+void UGruxDecisionSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Agents.Add(Enemy) == INDEX_NONE) return;
+
+	ApplyDecisionMode(*Enemy);
+}
+
+void UGruxDecisionSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	FGruxAgent* Agent{ Agents.Find(Enemy) };
+	if (Agent == nullptr) return;
+
+	if (bUseNativeDecisions && Agent->bEntered)
+	{
+		ExitState(*Agent, *Enemy);
+	}
+	Agents.Remove(Enemy);
+}
+
+void UGruxDecisionSubsystem::SetUseNativeDecisions(bool bUseNative)
+{
+	if (bUseNativeDecisions == bUseNative) return;
+	bUseNativeDecisions = bUseNative;
+
+	for (FGruxAgent& Agent : Agents)
+	{
+		AEnemy* Enemy{ Agent.Enemy.Get() };
+		if (Enemy == nullptr) continue;
+
+		// Hand movement over cleanly; the native state is entered again on the next decision
+		if (Agent.bEntered)
+		{
+			ExitState(Agent, *Enemy);
+			Agent.bEntered = false;
+		}
+		Agent.NextDecisionTime = 0.f;
+		ApplyDecisionMode(*Enemy);
+	}
+}
+
+EGruxState UGruxDecisionSubsystem::ChooseState(const AEnemy& Enemy)
+{
+	if (Enemy.IsDying()) return EGruxState::EGS_Dead;
+	if (Enemy.IsStunned()) return EGruxState::EGS_Stunned;
+	if (Enemy.GetAgroTarget() == nullptr) return EGruxState::EGS_Patrol;
+	if (Enemy.IsWaitingForAttackToken()) return EGruxState::EGS_Circle;
+	if (Enemy.IsInAttackRange()) return EGruxState::EGS_Attack;
+	return EGruxState::EGS_Chase;
+}
+
+void UGruxDecisionSubsystem::Decide(FGruxAgent& Agent, AEnemy& Enemy)
+{
+	const EGruxState NewState{ ChooseState(Enemy) };
+	if (NewState != Agent.State || !Agent.bEntered)
+	{
+		if (Agent.bEntered)
+		{
+			ExitState(Agent, Enemy);
+		}
+		Agent.State = NewState;
+		EnterState(Agent, Enemy);
+		Agent.bEntered = true;
+	}
+	UpdateState(Agent, Enemy);
+}
+
+void UGruxDecisionSubsystem::EnterState(FGruxAgent& Agent, AEnemy& Enemy)
+{
+	AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	if (EnemyController == nullptr) return;
+
+	switch (Agent.State)
+	{
+	case EGruxState::EGS_Patrol:
+		MoveToPatrolPoint(Enemy);
+		break;
+
+	case EGruxState::EGS_Chase:
+		if (UFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UFlowFieldSubsystem>())
+		{
+			Agent.ChaseTarget = Enemy.GetAgroTarget();
+			FlowFields->StartChase(EnemyController, Agent.ChaseTarget.Get(), ChaseAcceptanceRadius);
+		}
+		break;
+
+	case EGruxState::EGS_Circle:
+		if (const AActor* Target = Enemy.GetAgroTarget())
+		{
+			const FVector FromTarget{ Enemy.GetActorLocation() - Target->GetActorLocation() };
+			Agent.CircleAngle = FMath::RadiansToDegrees(FMath::Atan2(FromTarget.Y, FromTarget.X));
+			Agent.bCircleClockwise = FMath::RandBool();
+			MoveToCirclePoint(Agent, Enemy);
+		}
+		break;
+
+	case EGruxState::EGS_Attack:
+	case EGruxState::EGS_Stunned:
+	case EGruxState::EGS_Dead:
+		EnemyController->StopMovement();
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGruxDecisionSubsystem::ExitState(FGruxAgent& Agent, AEnemy& Enemy)
+{
+	AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	if (EnemyController == nullptr) return;
+
+	switch (Agent.State)
+	{
+	case EGruxState::EGS_Patrol:
+	case EGruxState::EGS_Circle:
+		EnemyController->StopMovement();
+		break;
+
+	case EGruxState::EGS_Chase:
+		if (UFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UFlowFieldSubsystem>())
+		{
+			FlowFields->StopChase(EnemyController);
+		}
+		Agent.ChaseTarget = nullptr;
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGruxDecisionSubsystem::UpdateState(FGruxAgent& Agent, AEnemy& Enemy)
+{
+	AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	if (EnemyController == nullptr) return;
+
+	switch (Agent.State)
+	{
+	case EGruxState::EGS_Patrol:
+		// Arrived, or the move failed; head for the next waypoint
+		if (EnemyController->GetMoveStatus() == EPathFollowingStatus::Idle)
+		{
+			Enemy.AdvancePatrol();
+			MoveToPatrolPoint(Enemy);
+		}
+		break;
+
+	case EGruxState::EGS_Chase:
+		if (Enemy.GetAgroTarget() != Agent.ChaseTarget.Get())
+		{
+			ExitState(Agent, Enemy);
+			EnterState(Agent, Enemy);
+		}
+		break;
+
+	case EGruxState::EGS_Attack:
+		if (Enemy.CanAttack())
+		{
+			if (const AActor* Target = Enemy.GetAgroTarget())
+			{
+				const FVector ToTarget{ Target->GetActorLocation() - Enemy.GetActorLocation() };
+				Enemy.SetActorRotation(FRotator(0.f, ToTarget.Rotation().Yaw, 0.f));
+			}
+			Enemy.PlayRandomAttack();
+		}
+		break;
+
+	case EGruxState::EGS_Circle:
+		// A granted token sends the enemy back to chase or attack on its next decision
+		if (Enemy.CanAttack() && Enemy.RequestAttackToken()) break;
+
+		if (EnemyController->GetMoveStatus() == EPathFollowingStatus::Idle)
+		{
+			MoveToCirclePoint(Agent, Enemy);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGruxDecisionSubsystem::MoveToPatrolPoint(AEnemy& Enemy) const
+{
+	AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	if (EnemyController == nullptr) return;
+
+	// Patrol legs repeat, so their paths are shared through the path cache
+	if (UPathCacheSubsystem* PathCache = GetWorld()->GetSubsystem<UPathCacheSubsystem>())
+	{
+		PathCache->MoveToLocation(EnemyController, Enemy.GetPatrolDestination(), PatrolAcceptanceRadius);
+	}
+	else
+	{
+		EnemyController->MoveToLocation(Enemy.GetPatrolDestination(), PatrolAcceptanceRadius);
+	}
+}
+
+void UGruxDecisionSubsystem::MoveToCirclePoint(FGruxAgent& Agent, AEnemy& Enemy) const
+{
+	AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	const AActor* Target{ Enemy.GetAgroTarget() };
+	if (EnemyController == nullptr || Target == nullptr) return;
+
+	Agent.CircleAngle += Agent.bCircleClockwise ? -CircleStepAngle : CircleStepAngle;
+	const float AngleRadians{ FMath::DegreesToRadians(Agent.CircleAngle) };
+	const FVector CirclePoint{ Target->GetActorLocation() + FVector(FMath::Cos(AngleRadians), FMath::Sin(AngleRadians), 0.f) * CircleRadius };
+
+	EnemyController->MoveToLocation(CirclePoint, PatrolAcceptanceRadius, true, false);
+}
+
+void UGruxDecisionSubsystem::ApplyDecisionMode(AEnemy& Enemy) const
+{
+	const AEnemyController* EnemyController{ Enemy.GetEnemyController() };
+	UBrainComponent* Brain{ EnemyController ? EnemyController->GetBrainComponent() : nullptr };
+	if (Brain == nullptr) return;
+
+	if (bUseNativeDecisions && Brain->IsRunning())
+	{
+		Brain->StopLogic(TEXT("Native decisions"));
+	}
+	else if (!bUseNativeDecisions && !Brain->IsRunning())
+	{
+		Brain->RestartLogic();
+	}
+}
+
+void UGruxDecisionSubsystem::LogReport() const
+{
+	int32 StateCounts[static_cast<int32>(EGruxState::EGS_MAX)] = {};
+	for (const FGruxAgent& Agent : Agents)
+	{
+		StateCounts[static_cast<int32>(Agent.State)]++;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%d Grux, native decisions %s; %d patrol, %d chase, %d attack, %d circle, %d stunned, %d dead; %d decisions last frame"),
+		Agents.Num(),
+		bUseNativeDecisions ? TEXT("on") : TEXT("off"),
+		StateCounts[static_cast<int32>(EGruxState::EGS_Patrol)],
+		StateCounts[static_cast<int32>(EGruxState::EGS_Chase)],
+		StateCounts[static_cast<int32>(EGruxState::EGS_Attack)],
+		StateCounts[static_cast<int32>(EGruxState::EGS_Circle)],
+		StateCounts[static_cast<int32>(EGruxState::EGS_Stunned)],
+		StateCounts[static_cast<int32>(EGruxState::EGS_Dead)],
+		LastDecisions);
+}
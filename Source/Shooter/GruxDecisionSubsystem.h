@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAgentSubsystem.h"
+#include "Tickable.h"
+#include "GruxDecisionSubsystem.generated.h"
+
+class AEnemy;
+
+UENUM(BlueprintType)
+enum class EGruxState : uint8
+{
+	EGS_Patrol UMETA(DisplayName = "Patrol"),
+	EGS_Chase UMETA(DisplayName = "Chase"),
+	EGS_Attack UMETA(DisplayName = "Attack"),
+	EGS_Circle UMETA(DisplayName = "Circle"),
+	EGS_Stunned UMETA(DisplayName = "Stunned"),
+	EGS_Dead UMETA(DisplayName = "Dead"),
+
+	EGS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/** A Grux driven by the native decision core */
+struct FGruxAgent
+{
+	TWeakObjectPtr<AEnemy> Enemy;
+
+	EGruxState State = EGruxState::EGS_Patrol;
+
+	/** False until State was entered; set again when decisions go back to native */
+	bool bEntered = false;
+
+	/** Target of the running chase */
+	TWeakObjectPtr<AActor> ChaseTarget;
+
+	/** Bearing from the target of the point being circled to, in degrees */
+	float CircleAngle = 0.f;
+
+	/** Direction of travel around the target while circling */
+	bool bCircleClockwise = false;
+
+	/** World time of the next decision; spaced by the enemy's AI LOD decision interval */
+	float NextDecisionTime = 0.f;
+};
+
+/**
+ * Native decision core for the Grux: a state machine over patrol, chase,
+ * attack, circle, stunned and dead, decided from the enemy's own fields rather
+ * than blackboard keys. Enemies denied an attack token circle the target on
+ * direct moves until one frees up. Enemies are evaluated round-robin in
+ * time-sliced batches. With native decisions off, every enemy runs its
+ * behavior tree instead.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UGruxDecisionSubsystem : public UEnemyAgentSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGruxDecisionSubsystem();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Called when an enemy starts playing or wakes from the pool; stops or restarts its behavior tree */
+	void RegisterEnemy(AEnemy* Enemy);
+
+	/** Called when an enemy ends play or goes dormant */
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** Switches every enemy between native decisions and its behavior tree */
+	void SetUseNativeDecisions(bool bUseNative);
+
+	FORCEINLINE bool UsesNativeDecisions() const { return bUseNativeDecisions; }
+
+	/** Logs the number of enemies in each state and the decisions of the last frame */
+	void LogReport() const;
+
+private:
+	/** Picks the state from the enemy's fields; the highest priority state wins */
+	static EGruxState ChooseState(const AEnemy& Enemy);
+
+	/** Moves Agent to the state its enemy is in and runs that state */
+	void Decide(FGruxAgent& Agent, AEnemy& Enemy);
+
+	void EnterState(FGruxAgent& Agent, AEnemy& Enemy);
+	void ExitState(FGruxAgent& Agent, AEnemy& Enemy);
+	void UpdateState(FGruxAgent& Agent, AEnemy& Enemy);
+
+	/** Moves toward the waypoint the enemy's patrol heads to, along a cached path when there is one */
+	void MoveToPatrolPoint(AEnemy& Enemy) const;
+
+	/** Moves straight, without pathfinding, to the next point on the ring around the target */
+	void MoveToCirclePoint(FGruxAgent& Agent, AEnemy& Enemy) const;
+
+	/** Stops or restarts the behavior tree of Enemy to match bUseNativeDecisions */
+	void ApplyDecisionMode(AEnemy& Enemy) const;
+
+	/** When false, enemies run their behavior tree. Off by default; Shooter.Grux.NativeDecisions 1 opts in */
+	UPROPERTY(Config)
+	bool bUseNativeDecisions;
+
+	/** Enemies considered per frame */
+	UPROPERTY(Config)
+	int32 AgentsPerTick;
+
+	/** Patrol points within this distance count as reached */
+	UPROPERTY(Config)
+	float PatrolAcceptanceRadius;
+
+	/** Chases stop this far from the target */
+	UPROPERTY(Config)
+	float ChaseAcceptanceRadius;
+
+	/** Distance from the target that enemies waiting for an attack token keep */
+	UPROPERTY(Config)
+	float CircleRadius;
+
+	/** Degrees around the target covered by each circling move */
+	UPROPERTY(Config)
+	float CircleStepAngle;
+
+	TEnemyAgentRegistry<FGruxAgent> Agents;
+
+	/** Next agent to consider */
+	int32 NextAgentIndex;
+
+	/** Decisions made in the last frame */
+	int32 LastDecisions;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Item.h"
+#include "AmmoType.h"
+#include "WeaponType.h"
+#include "WeaponModifier.h"
+#include <type_traits>
+#include "InventoryRecord.generated.h"
+
+/**
+ * A weapon held in the Character's inventory but not equipped.
+ * Only the equipped weapon exists as an actor; the others are kept as records
+ * and materialized from the item pool when equipped.
+ */
+USTRUCT(BlueprintType)
+struct FInventoryRecord
+{
+	GENERATED_BODY()
+
+	/** Object path of the weapon's Blueprint class; None uses the Character's DefaultWeaponClass */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FName WeaponClassPath;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EWeaponType WeaponType = EWeaponType::EWT_SubmachineGun;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EItemRarity ItemRarity = EItemRarity::EIR_Common;
+
+	/** Ammo left in the magazine */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Ammo = 0;
+
+	/** Number of valid entries in ModifierNames */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 NumModifiers = 0;
+
+	/** Names of the weapon's modifiers, registered with UItemDefinitionSubsystem, in the order they were added */
+	UPROPERTY()
+	FName ModifierNames[MaxWeaponModifiers];
+};
+
+/**
+ * Inventory slots and carried ammo in one fixed-size block with no pointers,
+ * so the whole inventory can be copied with a memcpy for rollback and
+ * replication deltas. Classes and modifiers are kept as FNames, whose indices
+ * only hold for the session; saves serialize the records as properties, which
+ * writes the names out as strings.
+ */
+struct FInventoryState
+{
+	static constexpr int32 Capacity{ 6 };
+	static constexpr int32 NumAmmoTypes{ (int32)EAmmoType::EAT_NAX };
+	static constexpr uint8 AllSlotsMask{ (1 << Capacity) - 1 };
+
+	FInventoryRecord Slots[Capacity];
+
+	/** Bit N is set when Slots[N] holds a weapon */
+	uint8 OccupiedSlots = 0;
+
+	/** Carried ammo, indexed by EAmmoType */
+	int32 Ammo[NumAmmoTypes] = {};
+
+	FORCEINLINE bool IsOccupied(int32 Slot) const
+	{
+		return Slot >= 0 && Slot < Capacity && (OccupiedSlots & (1 << Slot)) != 0;
+	}
+
+	FORCEINLINE int32 Num() const { return FMath::CountBits(OccupiedSlots); }
+	FORCEINLINE bool IsFull() const { return OccupiedSlots == AllSlotsMask; }
+
+	/** Lowest free slot, or INDEX_NONE when full */
+	FORCEINLINE int32 FindEmptySlot() const
+	{
+		const uint32 FreeSlots{ (uint32)(~OccupiedSlots & AllSlotsMask) };
+		return FreeSlots ? (int32)FMath::CountTrailingZeros(FreeSlots) : INDEX_NONE;
+	}
+
+	FORCEINLINE void SetSlot(int32 Slot, const FInventoryRecord& Record)
+	{
+		check(Slot >= 0 && Slot < Capacity);
+		Slots[Slot] = Record;
+		OccupiedSlots |= (1 << Slot);
+	}
+
+	FORCEINLINE void ClearSlot(int32 Slot)
+	{
+		check(Slot >= 0 && Slot < Capacity);
+		Slots[Slot] = FInventoryRecord();
+		OccupiedSlots &= ~(1 << Slot);
+	}
+
+	FORCEINLINE int32& GetAmmo(EAmmoType AmmoType)
+	{
+		check((int32)AmmoType < NumAmmoTypes);
+		return Ammo[(int32)AmmoType];
+	}
+
+	FORCEINLINE int32 GetAmmo(EAmmoType AmmoType) const
+	{
+		return (int32)AmmoType < NumAmmoTypes ? Ammo[(int32)AmmoType] : 0;
+	}
+};
+
+static_assert(std::is_trivially_copyable<FInventoryState>::value, "FInventoryState must stay memcpy-able");
+static_assert(FInventoryState::Capacity <= 8, "OccupiedSlots has one bit per slot");
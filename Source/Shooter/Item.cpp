@@ -6,10 +6,19 @@
 #include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
 #include "ShooterCharacter.h"
-#include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Curves/CurveVector.h"
+#include "ItemDefinitionSubsystem.h"
+#include "ShooterTuning.h"
+#include "Engine/CollisionProfile.h"
+#include "ItemPoolSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Drop Transition"), STAT_ItemDropTransition, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Item Pickup Transition"), STAT_ItemPickupTransition, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Item Equip Transition"), STAT_ItemEquipTransition, STATGROUP_Shooter);
+DECLARE_CYCLE_STAT(TEXT("Item Reset Transition"), STAT_ItemResetTransition, STATGROUP_Shooter);
 
 // Sets default values
 AItem::AItem() :
@@ -18,13 +27,9 @@ AItem::AItem() :
 	ItemRarity(EItemRarity::EIR_Common),
 	ItemState(EItemState::EIS_Pickup),
 	// Item interp variables
-	ZCurveTime(0.7f),
-	ItemInterpStartLocation(FVector(0.f)),
-	CameraTargetLocation(FVector(0.f)),
 	bInterping(false),
-	ItemInterpX(0.f),
-	ItemInterpY(0.f),
-	InterpInitialYawOffset(0.f),
+	InterpElapsedTime(0.f),
+	ZCurveTime(0.7f),
 	ItemType(EItemType::EIT_MAX),
 	InterpLocIndex(0),
 	MaterialIndex(0),
@@ -35,7 +40,10 @@ AItem::AItem() :
 	FresnelReflectFraction(4.f),
 	PulseCurveTime(5.f),
 	SlotIndex(0),
-	bCharacterInventoryFull(false)
+	bCharacterInventoryFull(false),
+	SpawnTime(0.f),
+	bPlayerDropped(false),
+	bDemoted(false)
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -81,6 +89,57 @@ void AItem::BeginPlay()
 	InitializeCustomDepth();
 
 	StartPulseTimer();
+
+	SpawnTime = GetWorld()->GetTimeSeconds();
+
+	// Track the item as active in the world's item pool
+	if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+	{
+		ItemPool->RegisterActiveItem(this);
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+	{
+		ItemPool->UnregisterItem(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::ResetItem()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	// Interp and inventory state
+	bInterping = false;
+	InterpElapsedTime = 0.f;
+	Character = nullptr;
+	SlotIndex = 0;
+	bCharacterInventoryFull = false;
+	SetActorScale3D(FVector(1.f));
+
+	// Budget state
+	SpawnTime = GetWorld()->GetTimeSeconds();
+	bPlayerDropped = false;
+	bDemoted = false;
+
+	// Collision and visibility
+	ItemState = EItemState::EIS_Pickup;
+	SetItemProperties(ItemState);
+	if (PickupWidget)
+	{
+		PickupWidget->SetVisibility(false);
+	}
+
+	// Materials
+	bCanChangeCustomDepth = true;
+	InitializeCustomDepth();
+	EnableGlowMaterial();
+
+	StartPulseTimer();
 }
 
 void AItem::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -113,6 +172,7 @@ void AItem::SetActiveStars()
 	int8 _ItemRarity = (int8)ItemRarity;
 	int8 RarityCount = (int8)EItemRarity::EIR_MAX;
 
+	ActiveStars.Reset();
 	for (int8 i = 0; i < RarityCount; i++)
 	{
 		if (i <= _ItemRarity)
@@ -122,91 +182,89 @@ void AItem::SetActiveStars()
 	}
 }
 
-void AItem::SetItemProperties(EItemState State)
+const FItemStateCollision& AItem::GetStateCollision(EItemState State)
 {
-	switch (State)
+	// Mesh, AreaSphere and CollisionBox profiles for each EItemState; profiles are defined in DefaultEngine.ini
+	static const FItemStateCollision StateCollisions[] =
+	{
+		// EIS_Pickup
+		{ UCollisionProfile::NoCollision_ProfileName, TEXT("ItemAreaSphere"), TEXT("ItemTraceBox"), false, true, false },
+		// EIS_EquipInterping
+		{ UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, false, true, true },
+		// EIS_PickedUp
+		{ UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, false, false, true },
+		// EIS_Equipped
+		{ UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, false, true, false },
+		// EIS_Falling
+		{ TEXT("ItemFalling"), UCollisionProfile::NoCollision_ProfileName, UCollisionProfile::NoCollision_ProfileName, true, true, false },
+	};
+	static_assert(UE_ARRAY_COUNT(StateCollisions) == (int32)EItemState::EIS_MAX, "Missing collision settings for an item state");
+
+	const int32 Index{ FMath::Clamp((int32)State, 0, (int32)EItemState::EIS_MAX - 1) };
+	return StateCollisions[Index];
+}
+
+void AItem::ApplyMeshStateCollision(UPrimitiveComponent* Mesh, const FItemStateCollision& StateCollision)
+{
+	if (Mesh == nullptr) return;
+
+	// Collision must be enabled before simulating and physics stopped before disabling it
+	if (!StateCollision.bSimulatePhysics && Mesh->IsSimulatingPhysics())
+	{
+		Mesh->SetSimulatePhysics(false);
+	}
+	if (Mesh->GetCollisionProfileName() != StateCollision.MeshProfile)
+	{
+		Mesh->SetCollisionProfileName(StateCollision.MeshProfile);
+	}
+	if (StateCollision.bSimulatePhysics && !Mesh->IsSimulatingPhysics())
+	{
+		Mesh->SetSimulatePhysics(true);
+	}
+	Mesh->SetEnableGravity(StateCollision.bSimulatePhysics);
+	Mesh->SetVisibility(StateCollision.bMeshVisible);
+}
+
+void AItem::ApplyStateCollision(const FItemStateCollision& StateCollision)
+{
+	if (StateCollision.bHidePickupWidget)
 	{
-	case EItemState::EIS_Pickup:
-		// Set mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionResponseToChannel(
-			ECollisionChannel::ECC_Visibility,
-			ECollisionResponse::ECR_Block);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		break;
-	case EItemState::EIS_Equipped:
-		// Set mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_Falling:
-		// Set mesh properties
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		ItemMesh->SetSimulatePhysics(true);
-		ItemMesh->SetEnableGravity(true);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionResponseToChannel(
-			ECollisionChannel::ECC_WorldStatic,
-			ECollisionResponse::ECR_Block);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_EquipInterping:
-		PickupWidget->SetVisibility(false);
-		// Set mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
-	case EItemState::EIS_PickedUp:
 		PickupWidget->SetVisibility(false);
-		// Set mesh properties
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set AreaSphere properties
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		// Set CollisionBox properties
-		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		CollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
+	}
+	ApplyMeshStateCollision(ItemMesh, StateCollision);
+	if (AreaSphere->GetCollisionProfileName() != StateCollision.AreaSphereProfile)
+	{
+		AreaSphere->SetCollisionProfileName(StateCollision.AreaSphereProfile);
+	}
+	if (CollisionBox->GetCollisionProfileName() != StateCollision.CollisionBoxProfile)
+	{
+		CollisionBox->SetCollisionProfileName(StateCollision.CollisionBoxProfile);
 	}
 }
 
+void AItem::SetItemProperties(EItemState State)
+{
+	// Cycle stat of each EItemState, so drops, pickups and equips can be compared with "stat Shooter"
+	static const TStatId TransitionStats[] =
+	{
+		// EIS_Pickup
+		GET_STATID(STAT_ItemResetTransition),
+		// EIS_EquipInterping
+		GET_STATID(STAT_ItemPickupTransition),
+		// EIS_PickedUp
+		GET_STATID(STAT_ItemPickupTransition),
+		// EIS_Equipped
+		GET_STATID(STAT_ItemEquipTransition),
+		// EIS_Falling
+		GET_STATID(STAT_ItemDropTransition),
+	};
+	static_assert(UE_ARRAY_COUNT(TransitionStats) == (int32)EItemState::EIS_MAX, "Missing cycle stat for an item state");
+
+	const int32 Index{ FMath::Clamp((int32)State, 0, (int32)EItemState::EIS_MAX - 1) };
+	FScopeCycleCounter CycleCounter(TransitionStats[Index]);
+	ApplyStateCollision(GetStateCollision(State));
+}
+
 void AItem::FinishInterping()
 {
 	bInterping = false;
@@ -226,81 +284,6 @@ void AItem::FinishInterping()
 	DisableCustomDepth();
 }
 
-void AItem::ItemInterp(float DeltaTime)
-{
-	if (!bInterping) return;
-
-	if (Character && ItemZCurve)
-	{
-		// Elapsed time since we started ItemInterpTimer
-		const float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-		// Get curve value corresponding to ElapsedTime
-		const float CurveValue = ItemZCurve->GetFloatValue(ElapsedTime);
-		UE_LOG(LogTemp, Warning, TEXT("CurveValue: %f"), CurveValue);
-		// Get the item's initial location when the curve started
-		FVector ItemLocation = ItemInterpStartLocation;
-		// Get location in front of the camera
-		const FVector CameraInterpLocation{ GetInterpLocation() };
-
-		// Vector from Item to Camera Interp Location, X and Y are zeroed out
-		const FVector ItemToCamera{ FVector(0.f, 0.f, (CameraInterpLocation - ItemLocation).Z) };
-		// Scale factor to multiply with CurveValue
-		const float DeltaZ = ItemToCamera.Size();
-
-		const FVector CurrentLocation{ GetActorLocation() };
-		// Interpolated X value
-		const float InterpXValue = FMath::FInterpTo(
-			CurrentLocation.X,
-			CameraInterpLocation.X,
-			DeltaTime,
-			30.0f);
-		// Interpolated Y value
-		const float InterpYValue = FMath::FInterpTo(
-			CurrentLocation.Y,
-			CameraInterpLocation.Y,
-			DeltaTime,
-			30.f);
-
-		// Set X and Y of ItemLocation to Interped values
-		ItemLocation.X = InterpXValue;
-		ItemLocation.Y = InterpYValue;
-
-		// Adding curve value to the Z component of the Initial Location (scaled by DeltaZ)
-		ItemLocation.Z += CurveValue * DeltaZ;
-		SetActorLocation(ItemLocation, true, nullptr, ETeleportType::TeleportPhysics);
-
-		// Camera rotation this frame
-		const FRotator CameraRotation{ Character->GetFollowCamera()->GetComponentRotation() };
-		// Camera rotation plus inital Yaw Offset
-		FRotator ItemRotation{ 0.f, CameraRotation.Yaw + InterpInitialYawOffset, 0.f };
-		SetActorRotation(ItemRotation, ETeleportType::TeleportPhysics);
-
-		if (ItemScaleCurve)
-		{
-			const float ScaleCurveValue = ItemScaleCurve->GetFloatValue(ElapsedTime);
-			SetActorScale3D(FVector(ScaleCurveValue));
-		}
-	}
-}
-
-FVector AItem::GetInterpLocation()
-{
-	if (Character == nullptr)
-	{
-		return FVector::ZeroVector;
-	}
-
-	switch (ItemType)
-	{
-	case EItemType::EIT_Ammo:
-		return Character->GetInterpLocation(InterpLocIndex).SceneComponent->GetComponentLocation();
-	case EItemType::EIT_Weapon:
-		return Character->GetInterpLocation(0).SceneComponent->GetComponentLocation();
-	default:
-		return FVector::ZeroVector;
-	}
-}
-
 void AItem::PlayPickupSound(bool bForcePlaySound)
 {
 	if (Character)
@@ -347,54 +330,64 @@ void AItem::InitializeCustomDepth()
 void AItem::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	
-	// Load the data in the Item Rarity Data Table
-	FString RarityTablePath{ TEXT("DataTable'/Game/_Game/DataTable/DT_ItemRarity.DT_ItemRarity'") }; // Path to the Item Rarity Data Table
-	UDataTable * RarityTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *RarityTablePath));
 
-	if (RarityTableObject)
+	ApplyRarityProperties();
+
+	if (MaterialInstance)
+	{
+		DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
+		DynamicMaterialInstance->SetVectorParameterValue(TEXT("FresnelColor"), GlowColor);
+		ItemMesh->SetMaterial(MaterialIndex, DynamicMaterialInstance);
+
+		EnableGlowMaterial();
+	}
+}
+
+void AItem::ApplyRarityProperties()
+{
+	const UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this);
+
+	// Cooked builds read the generated constexpr tables
+	if (const FRarityTuning* Tuning = ShooterTuning::FindRarity(ItemRarity))
 	{
-		FItemRarityTable* RarityRow = nullptr;
-		switch (ItemRarity)
+		GlowColor = Tuning->GlowColor.ToLinearColor();
+		LightColor = Tuning->LightColor.ToLinearColor();
+		DarkColor = Tuning->DarkColor.ToLinearColor();
+		NumberOfStars = Tuning->NumberOfStars;
+		IconBackground = ItemDefinitions ? ItemDefinitions->GetRarityIconBackground(ItemRarity) : nullptr;
+		if (GetItemMesh())
 		{
-		case EItemRarity::EIR_Damaged:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Damaged"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Common:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Common"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Uncommon:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Uncommon"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Rare:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Rare"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Legendary:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Legendary"), TEXT(""));
-			break;
+			GetItemMesh()->SetCustomDepthStencilValue(Tuning->CustomDepthStencil);
 		}
+		return;
+	}
 
-		if (RarityRow)
+	// Get the Item Rarity row from the cached item definitions
+	const FItemRarityTable* RarityRow = ItemDefinitions ? ItemDefinitions->GetRarityRow(ItemRarity) : nullptr;
+
+	if (RarityRow)
+	{
+		GlowColor = RarityRow->GlowColor;
+		LightColor = RarityRow->LightColor;
+		DarkColor = RarityRow->DarkColor;
+		NumberOfStars = RarityRow->NumberOfStars;
+		IconBackground = RarityRow->IconBackground;
+		if (GetItemMesh())
 		{
-			GlowColor = RarityRow->GlowColor;
-			LightColor = RarityRow->LightColor;
-			DarkColor = RarityRow->DarkColor;
-			NumberOfStars = RarityRow->NumberOfStars;
-			IconBackground = RarityRow->IconBackground;
-			if (GetItemMesh())
-			{
-				GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
-			}
+			GetItemMesh()->SetCustomDepthStencilValue(RarityRow->CustomDepthStencil);
 		}
 	}
+}
 
-	if (MaterialInstance)
+void AItem::SetItemRarity(EItemRarity Rarity)
+{
+	ItemRarity = Rarity;
+	ApplyRarityProperties();
+	SetActiveStars();
+
+	if (DynamicMaterialInstance)
 	{
-		DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
 		DynamicMaterialInstance->SetVectorParameterValue(TEXT("FresnelColor"), GlowColor);
-		ItemMesh->SetMaterial(MaterialIndex, DynamicMaterialInstance);
-
-		EnableGlowMaterial();
 	}
 }
 
@@ -430,7 +423,7 @@ void AItem::UpdatePulse()
 	case EItemState::EIS_EquipInterping:
 		if (InterpPulseCurve)
 		{
-			ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
+			ElapsedTime = InterpElapsedTime;
 			CurveValue = InterpPulseCurve->GetVectorValue(ElapsedTime);
 		}
 		break;
@@ -469,8 +462,6 @@ void AItem::PlayEquipSound(bool bForcePlaySound)
 void AItem::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	// Handle Item Interping when in the EquipInterping state
-	ItemInterp(DeltaTime);
 	// Get curve values from PulseCurve and set dynamic material parameters
 	UpdatePulse();
 }
@@ -488,6 +479,22 @@ void AItem::StartPulseTimer()
 	}
 }
 
+void AItem::SetDemoted(bool bDemote)
+{
+	if (bDemoted == bDemote) return;
+
+	bDemoted = bDemote;
+	SetActorTickEnabled(!bDemoted);
+	if (bDemoted)
+	{
+		GetWorldTimerManager().ClearTimer(PulseTimer);
+	}
+	else
+	{
+		StartPulseTimer();
+	}
+}
+
 void AItem::SetItemState(EItemState State)
 {
 	ItemState = State;
@@ -499,6 +506,9 @@ void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
 	// Store a handle to the Character
 	Character = Char;
 
+	// The pickup pulse and flight need the item ticking again
+	SetDemoted(false);
+
 	// Get array index in InterpLocations with the lowest item count
 	InterpLocIndex = Character->GetInterpLocationIndex();
 	// Add 1 to the Item Count for this interp location struct
@@ -506,24 +516,13 @@ void AItem::StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound)
 
 	PlayPickupSound(bForcePlaySound);
 
-	// Store initial location of the Item
-	ItemInterpStartLocation = GetActorLocation();
 	bInterping = true;
+	InterpElapsedTime = 0.f;
 	SetItemState(EItemState::EIS_EquipInterping);
 	GetWorldTimerManager().ClearTimer(PulseTimer);
 
-	GetWorldTimerManager().SetTimer(
-		ItemInterpTimer,
-		this,
-		&AItem::FinishInterping,
-		ZCurveTime);
-
-	// Get initial Yaw of the Camera
-	const float CameraRotationYaw{ Character->GetFollowCamera()->GetComponentRotation().Yaw };
-	// Get initial Yaw of the Item
-	const float ItemRotationYaw{ GetActorRotation().Yaw };
-	// Initial Yaw offset between Camera and Item
-	InterpInitialYawOffset = ItemRotationYaw - CameraRotationYaw;
+	// The Character moves all flying items together each frame
+	Character->StartItemFlight(this);
 
 	bCanChangeCustomDepth = false;
 }
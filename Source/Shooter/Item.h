@@ -64,11 +64,35 @@ struct FItemRarityTable : public FTableRowBase
 	int32 CustomDepthStencil;
 };
 
+/** Collision profiles and physics settings for an item's components in one EItemState */
+struct FItemStateCollision
+{
+	/** Collision profile for the item's mesh */
+	FName MeshProfile;
+
+	/** Collision profile for the AreaSphere */
+	FName AreaSphereProfile;
+
+	/** Collision profile for the CollisionBox */
+	FName CollisionBoxProfile;
+
+	/** True when the mesh simulates physics and gravity */
+	bool bSimulatePhysics;
+
+	/** True when the mesh is visible */
+	bool bMeshVisible;
+
+	/** True when the Pickup Widget is hidden on entering the state */
+	bool bHidePickupWidget;
+};
+
 UCLASS()
 class SHOOTER_API AItem : public AActor
 {
 	GENERATED_BODY()
 
+	friend class UItemPoolSubsystem;
+
 public:
 	// Sets default values for this actor's properties
 	AItem();
@@ -77,6 +101,11 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Restores the EIS_Pickup defaults: state, materials, timers and collision. Called by UItemPoolSubsystem */
+	virtual void ResetItem();
+
 	/** Called when overlapping AreaSphere */
 	UFUNCTION()
 	void OnSphereOverlap(
@@ -101,14 +130,14 @@ protected:
 	/** Sets properties of the Item's components based on State */
 	virtual void SetItemProperties(EItemState State);
 
-	/** Called when ItemInterpTimer is finished */
-	void FinishInterping();
+	/** Applies the collision profiles for a state to the Item's components */
+	virtual void ApplyStateCollision(const FItemStateCollision& StateCollision);
 
-	/** Handles item interpolation when in the EquipInterping state */
-	void ItemInterp(float DeltaTime);
+	/** Returns the precomputed collision settings for State */
+	static const FItemStateCollision& GetStateCollision(EItemState State);
 
-	/** Get interp location based on the item type */
-	FVector GetInterpLocation();
+	/** Applies the mesh profile, physics and visibility of StateCollision to Mesh */
+	static void ApplyMeshStateCollision(UPrimitiveComponent* Mesh, const FItemStateCollision& StateCollision);
 
 	void PlayPickupSound(bool bForcePlaySound = false);
 
@@ -116,6 +145,9 @@ protected:
 
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	/** Sets colors, icon background, NumberOfStars and custom depth stencil from the rarity tuning; ActiveStars is left to SetActiveStars */
+	void ApplyRarityProperties();
+
 	void EnableGlowMaterial();
 
 	void UpdatePulse();
@@ -169,18 +201,12 @@ private:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class UCurveFloat* ItemZCurve;
 
-	/** Starting location when interping begins */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector ItemInterpStartLocation;
-	/** Target interp location in front of the camera */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	FVector CameraTargetLocation;
 	/** true when interping */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	bool bInterping;
 
-	/** Plays when we start interping */
-	FTimerHandle ItemInterpTimer;
+	/** Time since interping began; advanced by the Character's item flight update */
+	float InterpElapsedTime;
 	/** Duration of the curve and timer */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float ZCurveTime;
@@ -189,13 +215,6 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class AShooterCharacter* Character;
 
-	/** X and Y for the Item while interping in the EquipInterping state */
-	float ItemInterpX;
-	float ItemInterpY;
-
-	/** Initial Yaw offset between the camera and the interping item */
-	float InterpInitialYawOffset;
-
 	/** Curve used to scale the item when interping */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	UCurveFloat* ItemScaleCurve;
@@ -269,6 +288,15 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
 	bool bCharacterInventoryFull;
 
+	/** World time at which the item was spawned or taken from the pool */
+	float SpawnTime;
+
+	/** True when the item was dropped by the player rather than spawned by the level or loot */
+	bool bPlayerDropped;
+
+	/** True while the item budget has turned off tick and pulse for this item */
+	bool bDemoted;
+
 	/** Item Rarity data table */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
 	class UDataTable* ItemRarityDataTable;
@@ -305,6 +333,11 @@ public:
 	FORCEINLINE USoundCue* GetEquipSound() const { return EquipSound; }
 	FORCEINLINE void SetEquipSound(USoundCue* Sound) { EquipSound = Sound; }
 	FORCEINLINE int32 GetItemCount() const { return ItemCount; }
+	FORCEINLINE void SetItemCount(int32 Count) { ItemCount = Count; }
+	FORCEINLINE EItemRarity GetItemRarity() const { return ItemRarity; }
+
+	/** Changes the rarity after construction; used for loot and pooled items */
+	void SetItemRarity(EItemRarity Rarity);
 	FORCEINLINE int32 GetSlotIndex() const { return SlotIndex; }
 	FORCEINLINE void SetSlotIndex(int32 Index) { SlotIndex = Index; }
 	FORCEINLINE void SetCharacter(AShooterCharacter* Char) { Character = Char; }
@@ -325,6 +358,23 @@ public:
 	/** Called from the AShooterCharacter class */
 	void StartItemCurve(AShooterCharacter* Char, bool bForcePlaySound = false);
 
+	/** Called from AShooterCharacter::UpdateItemFlights when the item reaches its interp location */
+	void FinishInterping();
+
+	FORCEINLINE UCurveFloat* GetItemZCurve() const { return ItemZCurve; }
+	FORCEINLINE UCurveFloat* GetItemScaleCurve() const { return ItemScaleCurve; }
+	FORCEINLINE float GetZCurveTime() const { return ZCurveTime; }
+	FORCEINLINE int32 GetInterpLocIndex() const { return InterpLocIndex; }
+	FORCEINLINE EItemType GetItemType() const { return ItemType; }
+	FORCEINLINE void SetInterpElapsedTime(float Time) { InterpElapsedTime = Time; }
+	FORCEINLINE float GetSpawnTime() const { return SpawnTime; }
+	FORCEINLINE bool IsPlayerDropped() const { return bPlayerDropped; }
+	FORCEINLINE void SetPlayerDropped(bool bDropped) { bPlayerDropped = bDropped; }
+	FORCEINLINE bool IsDemoted() const { return bDemoted; }
+
+	/** Called by UItemBudgetSubsystem; turns tick and the pulse timer off while demoted */
+	void SetDemoted(bool bDemote);
+
 	virtual void EnableCustomDepth();
 	virtual void DisableCustomDepth();
 	void DisableGlowMaterial();
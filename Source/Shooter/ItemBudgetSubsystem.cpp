@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemBudgetSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Components/WidgetComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Item.h"
+#include "ItemPoolSubsystem.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Budget"), STAT_ItemBudget, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Budgeted Items"), STAT_BudgetedItems, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Demoted Items"), STAT_DemotedItems, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Budget Evictions"), STAT_ItemBudgetEvictions, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld ItemBudgetReportCommand(
+	TEXT("Shooter.ItemBudget.Report"),
+	TEXT("Logs world item counts, demotions and evictions per item budget cap"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UItemBudgetSubsystem* ItemBudget = World ? World->GetSubsystem<UItemBudgetSubsystem>() : nullptr)
+		{
+			ItemBudget->LogReport();
+		}
+	}));
+
+UItemBudgetSubsystem::UItemBudgetSubsystem() :
+	EvaluationInterval(1.f),
+	RarityWeight(100.f),
+	DistanceWeight(1.f),
+	AgeWeight(0.5f),
+	PlayerDroppedBonus(50.f),
+	TimeSinceLastEvaluation(0.f)
+{
+
+}
+
+bool UItemBudgetSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World{ Cast<UWorld>(Outer) };
+	return World && World->IsGameWorld();
+}
+
+void UItemBudgetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CapClasses.Reset(Caps.Num());
+	for (const FItemBudgetCap& Cap : Caps)
+	{
+		CapClasses.Add(Cap.ItemClass.LoadSynchronous());
+	}
+	CapCounts.SetNum(Caps.Num());
+}
+
+void UItemBudgetSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceLastEvaluation += DeltaTime;
+	if (TimeSinceLastEvaluation >= EvaluationInterval)
+	{
+		TimeSinceLastEvaluation = 0.f;
+		EvaluateBudget();
+	}
+}
+
+bool UItemBudgetSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() != nullptr && Caps.Num() > 0;
+}
+
+TStatId UItemBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemBudgetSubsystem, STATGROUP_Tickables);
+}
+
+void UItemBudgetSubsystem::EvaluateBudget()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ItemBudget);
+
+	UWorld* World{ GetWorld() };
+	UItemPoolSubsystem* ItemPool{ World->GetSubsystem<UItemPoolSubsystem>() };
+	if (ItemPool == nullptr) return;
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+	const float CurrentTime{ World->GetTimeSeconds() };
+
+	struct FRankedItem
+	{
+		AItem* Item;
+		float Priority;
+	};
+	TArray<TArray<FRankedItem>, TInlineAllocator<4>> CapItems;
+	CapItems.SetNum(Caps.Num());
+
+	// Items lying in the world, grouped by cap; inventory and flying items are not budgeted
+	for (AItem* Item : ItemPool->GetActiveItems())
+	{
+		if (Item == nullptr || Item->IsHidden()) continue;
+		if (Item->GetItemState() != EItemState::EIS_Pickup && Item->GetItemState() != EItemState::EIS_Falling) continue;
+
+		const int32 CapIndex{ FindCapIndex(Item) };
+		if (CapIndex != INDEX_NONE)
+		{
+			CapItems[CapIndex].Add({ Item, GetItemPriority(Item, PlayerLocations, CurrentTime) });
+		}
+	}
+
+	int32 TotalItems{ 0 };
+	int32 TotalDemoted{ 0 };
+	TArray<AItem*, TInlineAllocator<16>> ToRelease;
+	for (int32 CapIndex = 0; CapIndex < Caps.Num(); ++CapIndex)
+	{
+		const FItemBudgetCap& Cap{ Caps[CapIndex] };
+		FItemBudgetCounts& Counts{ CapCounts[CapIndex] };
+		TArray<FRankedItem>& Ranked{ CapItems[CapIndex] };
+
+		// Lowest priority first
+		Ranked.Sort([](const FRankedItem& A, const FRankedItem& B) { return A.Priority < B.Priority; });
+
+		const int32 NumToEvict{ FMath::Max(Ranked.Num() - Cap.HardCap, 0) };
+		const int32 NumToDemote{ FMath::Max(Ranked.Num() - Cap.SoftCap, 0) };
+		int32 NumEvicted{ 0 };
+		Counts.Demoted = 0;
+		for (int32 Rank = 0; Rank < Ranked.Num(); ++Rank)
+		{
+			AItem* Item{ Ranked[Rank].Item };
+			// Falling items and the item the player is looking at are never removed
+			const bool bCanRemove{ Item->GetItemState() == EItemState::EIS_Pickup && !Item->GetPickupWidget()->IsVisible() };
+
+			if (Rank < NumToEvict && bCanRemove)
+			{
+				ToRelease.Add(Item);
+				NumEvicted++;
+			}
+			else if (Rank < NumToDemote && bCanRemove)
+			{
+				Item->SetDemoted(true);
+				Counts.Demoted++;
+			}
+			else
+			{
+				Item->SetDemoted(false);
+			}
+		}
+
+		Counts.Items = Ranked.Num() - NumEvicted;
+		Counts.Evictions += NumEvicted;
+		TotalItems += Counts.Items;
+		TotalDemoted += Counts.Demoted;
+	}
+
+	for (AItem* Item : ToRelease)
+	{
+		ItemPool->ReleaseItem(Item);
+	}
+
+	SET_DWORD_STAT(STAT_BudgetedItems, TotalItems);
+	SET_DWORD_STAT(STAT_DemotedItems, TotalDemoted);
+	INC_DWORD_STAT_BY(STAT_ItemBudgetEvictions, ToRelease.Num());
+}
+
+void UItemBudgetSubsystem::LogReport() const
+{
+	for (int32 CapIndex = 0; CapIndex < Caps.Num(); ++CapIndex)
+	{
+		const FItemBudgetCap& Cap{ Caps[CapIndex] };
+		const FItemBudgetCounts& Counts{ CapCounts[CapIndex] };
+		UE_LOG(LogTemp, Log, TEXT("%s: %d items (soft cap %d, hard cap %d), %d demoted, %d evicted"),
+			*GetNameSafe(CapClasses[CapIndex]),
+			Counts.Items,
+			Cap.SoftCap,
+			Cap.HardCap,
+			Counts.Demoted,
+			Counts.Evictions);
+	}
+}
+
+float UItemBudgetSubsystem::GetItemPriority(const AItem* Item, TArrayView<const FVector> PlayerLocations, float CurrentTime) const
+{
+	const FVector Location{ Item->GetActorLocation() };
+	float NearestDistSquared{ 0.f };
+	if (PlayerLocations.Num() > 0)
+	{
+		NearestDistSquared = TNumericLimits<float>::Max();
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			NearestDistSquared = FMath::Min(NearestDistSquared, FVector::DistSquared(PlayerLocation, Location));
+		}
+	}
+
+	// Distances are in centimeters
+	const float DistanceMeters{ FMath::Sqrt(NearestDistSquared) * 0.01f };
+	const float Age{ CurrentTime - Item->GetSpawnTime() };
+
+	return (int32)Item->GetItemRarity() * RarityWeight
+		- DistanceMeters * DistanceWeight
+		- Age * AgeWeight
+		+ (Item->IsPlayerDropped() ? PlayerDroppedBonus : 0.f);
+}
+
+int32 UItemBudgetSubsystem::FindCapIndex(const AItem* Item) const
+{
+	const UClass* ItemClass{ Item->GetClass() };
+	for (int32 CapIndex = 0; CapIndex < CapClasses.Num(); ++CapIndex)
+	{
+		if (CapClasses[CapIndex] && ItemClass->IsChildOf(CapClasses[CapIndex]))
+		{
+			return CapIndex;
+		}
+	}
+	return INDEX_NONE;
+}
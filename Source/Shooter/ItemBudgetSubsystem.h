@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ItemBudgetSubsystem.generated.h"
+
+class AItem;
+
+/** Item caps for one class of items */
+USTRUCT()
+struct FItemBudgetCap
+{
+	GENERATED_BODY()
+
+	/** Items of this class or a subclass count against this cap */
+	UPROPERTY(Config)
+	TSoftClassPtr<AItem> ItemClass;
+
+	/** Above this count the lowest priority items stop ticking and pulsing */
+	UPROPERTY(Config)
+	int32 SoftCap = 0;
+
+	/** Above this count the lowest priority items are returned to the item pool */
+	UPROPERTY(Config)
+	int32 HardCap = 0;
+};
+
+/** Item counts for one cap, from the last evaluation */
+struct FItemBudgetCounts
+{
+	int32 Items = 0;
+	int32 Demoted = 0;
+	int32 Evictions = 0;
+};
+
+/**
+ * Keeps the number of items lying in the world within per-class caps.
+ * Items are ranked by rarity, distance to the nearest player, age and whether
+ * the player dropped them; the lowest ranked are demoted at the soft cap and
+ * despawned at the hard cap.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UItemBudgetSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UItemBudgetSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Ranks the world items and demotes or despawns those over the caps */
+	void EvaluateBudget();
+
+	/** Logs the item, demoted and eviction counts per cap */
+	void LogReport() const;
+
+private:
+	/** Higher is kept longer */
+	float GetItemPriority(const AItem* Item, TArrayView<const FVector> PlayerLocations, float CurrentTime) const;
+
+	/** Index into Caps of the first cap matching Item's class, or INDEX_NONE */
+	int32 FindCapIndex(const AItem* Item) const;
+
+	/** Seconds between budget evaluations */
+	UPROPERTY(Config)
+	float EvaluationInterval;
+
+	/** Per-class caps; the first entry whose class matches is used, so list subclasses first */
+	UPROPERTY(Config)
+	TArray<FItemBudgetCap> Caps;
+
+	/** Priority gained per EItemRarity step above Damaged */
+	UPROPERTY(Config)
+	float RarityWeight;
+
+	/** Priority lost per meter from the nearest player */
+	UPROPERTY(Config)
+	float DistanceWeight;
+
+	/** Priority lost per second since the item was spawned */
+	UPROPERTY(Config)
+	float AgeWeight;
+
+	/** Priority gained by items the player dropped */
+	UPROPERTY(Config)
+	float PlayerDroppedBonus;
+
+	/** Caps resolved from their soft class pointers */
+	UPROPERTY()
+	TArray<UClass*> CapClasses;
+
+	TArray<FItemBudgetCounts> CapCounts;
+
+	float TimeSinceLastEvaluation;
+};
@@ -0,0 +1,285 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemDefinitionSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Engine/AssetManager.h"
+#include "WeaponDefinition.h"
+#include "ShooterTuning.h"
+
+namespace
+{
+	/** Data table row names, in EItemRarity order */
+	const TCHAR* RarityRowNames[] = { TEXT("Damaged"), TEXT("Common"), TEXT("Uncommon"), TEXT("Rare"), TEXT("Legendary") };
+	static_assert(UE_ARRAY_COUNT(RarityRowNames) == (int32)EItemRarity::EIR_MAX, "Missing Item Rarity row name");
+
+	/** Data table row names, in EWeaponType order */
+	const TCHAR* WeaponRowNames[] = { TEXT("SubmachineGun"), TEXT("AssaultRifle"), TEXT("Pistol") };
+	static_assert(UE_ARRAY_COUNT(WeaponRowNames) == (int32)EWeaponType::EWT_MAX, "Missing Weapon row name");
+}
+
+UItemDefinitionSubsystem::UItemDefinitionSubsystem() :
+	ItemRarityTablePath(TEXT("/Game/_Game/DataTable/DT_ItemRarity.DT_ItemRarity")),
+	WeaponTablePath(TEXT("/Game/_Game/DataTable/DT_Weapon.DT_Weapon")),
+	ItemRarityDataTable(nullptr),
+	WeaponDataTable(nullptr),
+	bTablesLoaded(false)
+{
+
+}
+
+void UItemDefinitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LoadTables();
+}
+
+void UItemDefinitionSubsystem::Deinitialize()
+{
+#if WITH_EDITOR
+	if (ItemRarityDataTable)
+	{
+		ItemRarityDataTable->OnDataTableChanged().RemoveAll(this);
+	}
+	if (WeaponDataTable)
+	{
+		WeaponDataTable->OnDataTableChanged().RemoveAll(this);
+	}
+#endif
+	RarityRows.Empty();
+	WeaponRows.Empty();
+	WeaponDefinitions.Empty();
+	WeaponAssetHandles.Empty();
+	WeaponAssetRequests.Empty();
+	ItemRarityDataTable = nullptr;
+	WeaponDataTable = nullptr;
+	bTablesLoaded = false;
+
+	Super::Deinitialize();
+}
+
+UItemDefinitionSubsystem* UItemDefinitionSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (GameInstance)
+	{
+		if (UItemDefinitionSubsystem* Subsystem = GameInstance->GetSubsystem<UItemDefinitionSubsystem>())
+		{
+			return Subsystem;
+		}
+	}
+
+	// No game instance (editor construction script); use the class default object as a cache
+	UItemDefinitionSubsystem* DefaultSubsystem = GetMutableDefault<UItemDefinitionSubsystem>();
+	DefaultSubsystem->LoadTables();
+	return DefaultSubsystem;
+}
+
+const FItemRarityTable* UItemDefinitionSubsystem::GetRarityRow(EItemRarity Rarity) const
+{
+	const int32 Index{ (int32)Rarity };
+	return RarityRows.IsValidIndex(Index) ? RarityRows[Index] : nullptr;
+}
+
+UTexture2D* UItemDefinitionSubsystem::GetRarityIconBackground(EItemRarity Rarity) const
+{
+	const int32 Index{ (int32)Rarity };
+	if (RarityIconBackgrounds.IsValidIndex(Index))
+	{
+		return RarityIconBackgrounds[Index];
+	}
+
+	const FItemRarityTable* RarityRow{ GetRarityRow(Rarity) };
+	return RarityRow ? RarityRow->IconBackground : nullptr;
+}
+
+const FWeaponDataTable* UItemDefinitionSubsystem::GetWeaponRow(EWeaponType WeaponType) const
+{
+	const int32 Index{ (int32)WeaponType };
+	return WeaponRows.IsValidIndex(Index) ? WeaponRows[Index] : nullptr;
+}
+
+const UWeaponDefinition* UItemDefinitionSubsystem::GetWeaponDefinition(EWeaponType WeaponType) const
+{
+	const int32 Index{ (int32)WeaponType };
+	return WeaponDefinitions.IsValidIndex(Index) ? WeaponDefinitions[Index] : nullptr;
+}
+
+FName UItemDefinitionSubsystem::GetWeaponClassPath(TSubclassOf<AWeapon> WeaponClass)
+{
+	if (WeaponClass == nullptr) return NAME_None;
+
+	const FName ClassPath{ *WeaponClass->GetPathName() };
+	WeaponClasses.Add(ClassPath, WeaponClass);
+	return ClassPath;
+}
+
+TSubclassOf<AWeapon> UItemDefinitionSubsystem::GetWeaponClass(FName ClassPath)
+{
+	if (ClassPath.IsNone()) return nullptr;
+
+	if (const TSubclassOf<AWeapon>* WeaponClass = WeaponClasses.Find(ClassPath))
+	{
+		return *WeaponClass;
+	}
+
+	// Records restored from a save name classes this session has not seen yet
+	TSubclassOf<AWeapon> WeaponClass{ TSoftClassPtr<AWeapon>(FSoftObjectPath(ClassPath.ToString())).LoadSynchronous() };
+	if (WeaponClass)
+	{
+		WeaponClasses.Add(ClassPath, WeaponClass);
+	}
+	return WeaponClass;
+}
+
+void UItemDefinitionSubsystem::RegisterWeaponModifier(const FWeaponModifier& Modifier)
+{
+	if (!Modifier.ModifierName.IsNone())
+	{
+		WeaponModifiers.Add(Modifier.ModifierName, Modifier);
+	}
+}
+
+const FWeaponModifier* UItemDefinitionSubsystem::GetWeaponModifier(FName ModifierName) const
+{
+	return WeaponModifiers.Find(ModifierName);
+}
+
+void UItemDefinitionSubsystem::RequestWeaponAssets(EWeaponType WeaponType, FStreamableDelegate OnLoaded)
+{
+	const UWeaponDefinition* Definition{ GetWeaponDefinition(WeaponType) };
+	if (Definition == nullptr) return;
+
+	WeaponAssetRequests.SetNumZeroed((int32)EWeaponType::EWT_MAX);
+	WeaponAssetRequests[(int32)WeaponType]++;
+
+	if (Definition->AreAssetsLoaded())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	UAssetManager* AssetManager{ UAssetManager::GetIfValid() };
+	if (AssetManager == nullptr)
+	{
+		Definition->LoadAssetsSynchronous();
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	// Asset definitions that are not loaded yet; rows' definitions are always loaded
+	WeaponAssetHandles.SetNum((int32)EWeaponType::EWT_MAX);
+	WeaponAssetHandles[(int32)WeaponType] = AssetManager->LoadPrimaryAsset(
+		Definition->GetPrimaryAssetId(),
+		{ UWeaponDefinition::WorldBundle, UWeaponDefinition::UIBundle },
+		OnLoaded);
+}
+
+void UItemDefinitionSubsystem::ReleaseWeaponAssets(EWeaponType WeaponType)
+{
+	const int32 Index{ (int32)WeaponType };
+	if (!WeaponAssetRequests.IsValidIndex(Index) || WeaponAssetRequests[Index] == 0) return;
+
+	// Memory follows the weapon types in play, not every type seen this session
+	if (--WeaponAssetRequests[Index] == 0 && WeaponAssetHandles.IsValidIndex(Index) && WeaponAssetHandles[Index].IsValid())
+	{
+		WeaponAssetHandles[Index]->ReleaseHandle();
+		WeaponAssetHandles[Index].Reset();
+	}
+}
+
+void UItemDefinitionSubsystem::LoadTables()
+{
+	if (bTablesLoaded) return;
+	bTablesLoaded = true;
+
+#if SHOOTER_USE_GENERATED_TUNING
+	// Rarity values are compiled in; only the textures need loading
+	RarityIconBackgrounds.Init(nullptr, (int32)EItemRarity::EIR_MAX);
+	for (int32 i = 0; i < RarityIconBackgrounds.Num(); i++)
+	{
+		const FRarityTuning* Tuning{ ShooterTuning::FindRarity((EItemRarity)i) };
+		if (Tuning && *Tuning->IconBackgroundPath)
+		{
+			RarityIconBackgrounds[i] = Cast<UTexture2D>(FSoftObjectPath(Tuning->IconBackgroundPath).TryLoad());
+		}
+	}
+#else
+	ItemRarityDataTable = Cast<UDataTable>(ItemRarityTablePath.TryLoad());
+#endif
+
+	// The Weapon data table hard references every weapon's assets; only load it for types without a definition asset
+	LoadWeaponDefinitionAssets();
+	if (WeaponDefinitions.Contains(nullptr))
+	{
+		WeaponDataTable = Cast<UDataTable>(WeaponTablePath.TryLoad());
+	}
+
+#if WITH_EDITOR
+	// Row memory is reallocated when a table is edited or reimported
+	if (ItemRarityDataTable)
+	{
+		ItemRarityDataTable->OnDataTableChanged().AddUObject(this, &UItemDefinitionSubsystem::RebuildRows);
+	}
+	if (WeaponDataTable)
+	{
+		WeaponDataTable->OnDataTableChanged().AddUObject(this, &UItemDefinitionSubsystem::RebuildRows);
+	}
+#endif
+
+	RebuildRows();
+}
+
+void UItemDefinitionSubsystem::RebuildRows()
+{
+	RarityRows.Init(nullptr, (int32)EItemRarity::EIR_MAX);
+	if (ItemRarityDataTable)
+	{
+		for (int32 i = 0; i < RarityRows.Num(); i++)
+		{
+			RarityRows[i] = ItemRarityDataTable->FindRow<FItemRarityTable>(FName(RarityRowNames[i]), TEXT("UItemDefinitionSubsystem"));
+		}
+	}
+
+	WeaponRows.Init(nullptr, (int32)EWeaponType::EWT_MAX);
+	if (WeaponDataTable)
+	{
+		for (int32 i = 0; i < WeaponRows.Num(); i++)
+		{
+			WeaponRows[i] = WeaponDataTable->FindRow<FWeaponDataTable>(FName(WeaponRowNames[i]), TEXT("UItemDefinitionSubsystem"));
+		}
+	}
+
+	// Types without a definition asset use a definition built from their row
+	for (int32 i = 0; i < WeaponDefinitions.Num(); i++)
+	{
+		const bool bHasAsset{ WeaponDefinitions[i] && !WeaponDefinitions[i]->HasAnyFlags(RF_Transient) };
+		if (!bHasAsset)
+		{
+			WeaponDefinitions[i] = WeaponRows[i] ? UWeaponDefinition::CreateFromRow(this, (EWeaponType)i, *WeaponRows[i]) : nullptr;
+		}
+	}
+}
+
+void UItemDefinitionSubsystem::LoadWeaponDefinitionAssets()
+{
+	WeaponDefinitions.Init(nullptr, (int32)EWeaponType::EWT_MAX);
+
+	// Definition assets only hold gameplay values and soft references, so loading them is cheap
+	UAssetManager* AssetManager{ UAssetManager::GetIfValid() };
+	if (AssetManager == nullptr) return;
+
+	TArray<FPrimaryAssetId> DefinitionIds;
+	AssetManager->GetPrimaryAssetIdList(UWeaponDefinition::PrimaryAssetType, DefinitionIds);
+	for (const FPrimaryAssetId& DefinitionId : DefinitionIds)
+	{
+		UWeaponDefinition* Definition = Cast<UWeaponDefinition>(AssetManager->GetPrimaryAssetPath(DefinitionId).TryLoad());
+		if (Definition && WeaponDefinitions.IsValidIndex((int32)Definition->WeaponType))
+		{
+			WeaponDefinitions[(int32)Definition->WeaponType] = Definition;
+		}
+	}
+}
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "Engine/StreamableManager.h"
+#include "ItemDefinitionSubsystem.generated.h"
+
+class UWeaponDefinition;
+
+/**
+ * Loads the Item Rarity and Weapon data tables once and exposes their rows
+ * as arrays indexed by EItemRarity and EWeaponType.
+ * Weapon definitions come from UWeaponDefinition primary assets; types without
+ * one fall back to a definition built from the Weapon data table row.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UItemDefinitionSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemDefinitionSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	* Returns the subsystem of the world's game instance. Construction scripts
+	* run in the editor have no game instance; they share the class default object instead.
+	*/
+	static UItemDefinitionSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Row of the Item Rarity data table for Rarity, or nullptr if missing */
+	const FItemRarityTable* GetRarityRow(EItemRarity Rarity) const;
+
+	/** Icon background texture for Rarity; from the generated tuning tables when they are used */
+	UTexture2D* GetRarityIconBackground(EItemRarity Rarity) const;
+
+	/** Row of the Weapon data table for WeaponType, or nullptr if missing */
+	const FWeaponDataTable* GetWeaponRow(EWeaponType WeaponType) const;
+
+	/** Definition for WeaponType, or nullptr if there is neither an asset nor a data table row */
+	const UWeaponDefinition* GetWeaponDefinition(EWeaponType WeaponType) const;
+
+	/**
+	* Streams the World and UI bundles of WeaponType's definition; call when a weapon of that type
+	* becomes relevant. OnLoaded runs right away if they are already loaded. The bundles stay loaded
+	* until every request is matched by a ReleaseWeaponAssets.
+	*/
+	void RequestWeaponAssets(EWeaponType WeaponType, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/** Ends one RequestWeaponAssets for WeaponType; the last one lets the bundles unload */
+	void ReleaseWeaponAssets(EWeaponType WeaponType);
+
+	/** Object path of WeaponClass for inventory records; the class is cached so it resolves without a lookup */
+	FName GetWeaponClassPath(TSubclassOf<AWeapon> WeaponClass);
+
+	/** Class at ClassPath, loaded if it was saved in an earlier session; nullptr for None or a missing class */
+	TSubclassOf<AWeapon> GetWeaponClass(FName ClassPath);
+
+	/** Registers Modifier under its name for inventory records; a later registration under the same name replaces its stats */
+	void RegisterWeaponModifier(const FWeaponModifier& Modifier);
+
+	/** Modifier registered under ModifierName, or nullptr */
+	const FWeaponModifier* GetWeaponModifier(FName ModifierName) const;
+
+private:
+	/** Loads both data tables and fills the enum indexed row arrays */
+	void LoadTables();
+
+	/** Fills the enum indexed row arrays from the loaded data tables, and weapon definitions missing an asset */
+	void RebuildRows();
+
+	/** Loads the UWeaponDefinition assets and indexes them by type */
+	void LoadWeaponDefinitionAssets();
+
+	/** Path to the Item Rarity data table */
+	UPROPERTY(Config)
+	FSoftObjectPath ItemRarityTablePath;
+
+	/** Path to the Weapon data table */
+	UPROPERTY(Config)
+	FSoftObjectPath WeaponTablePath;
+
+	/** Keeps the Item Rarity data table loaded */
+	UPROPERTY()
+	UDataTable* ItemRarityDataTable;
+
+	/** Keeps the Weapon data table loaded */
+	UPROPERTY()
+	UDataTable* WeaponDataTable;
+
+	/** Rows of the Item Rarity data table, indexed by EItemRarity */
+	TArray<const FItemRarityTable*> RarityRows;
+
+	/** Icon backgrounds loaded from the generated tuning tables' paths, indexed by EItemRarity */
+	UPROPERTY()
+	TArray<UTexture2D*> RarityIconBackgrounds;
+
+	/** Rows of the Weapon data table, indexed by EWeaponType */
+	TArray<const FWeaponDataTable*> WeaponRows;
+
+	/** Weapon definitions, indexed by EWeaponType */
+	UPROPERTY()
+	TArray<UWeaponDefinition*> WeaponDefinitions;
+
+	/** Weapon classes referenced by inventory records, by object path */
+	UPROPERTY()
+	TMap<FName, TSubclassOf<AWeapon>> WeaponClasses;
+
+	/** Weapon modifiers referenced by inventory records, by modifier name */
+	TMap<FName, FWeaponModifier> WeaponModifiers;
+
+	/** Keep requested definition bundles loaded, indexed by EWeaponType */
+	TArray<TSharedPtr<FStreamableHandle>> WeaponAssetHandles;
+
+	/** Requests not yet released, indexed by EWeaponType */
+	TArray<int32> WeaponAssetRequests;
+
+	bool bTablesLoaded;
+};
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemPoolSubsystem.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Items"), STAT_ActiveItems, STATGROUP_Shooter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Items"), STAT_PooledItems, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Pool Fallback Spawns"), STAT_ItemPoolFallbackSpawns, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld ItemPoolReportCommand(
+	TEXT("Shooter.ItemPool.Report"),
+	TEXT("Logs item pool occupancy and fallback allocations"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr)
+		{
+			ItemPool->LogReport();
+		}
+	}));
+
+UItemPoolSubsystem::UItemPoolSubsystem() :
+	MaxPrewarmPerClass(256)
+{
+
+}
+
+AItem* UItemPoolSubsystem::AcquireItem(TSubclassOf<AItem> ItemClass, const FTransform& Transform, TFunctionRef<void(AItem*)> InitItem)
+{
+	if (ItemClass == nullptr) return nullptr;
+
+	FItemPool* Pool{ Pools.Find(ItemClass) };
+	while (Pool && Pool->FreeItems.Num() > 0)
+	{
+		AItem* Item{ Pool->FreeItems.Pop(false) };
+		if (!IsValid(Item)) continue;
+
+		Item->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+		Item->SetActorHiddenInGame(false);
+		Item->SetActorEnableCollision(true);
+		Item->SetActorTickEnabled(true);
+		Item->ResetItem();
+		InitItem(Item);
+
+		ActiveItems.Add(Item);
+		Stats.PooledAcquires++;
+		UpdateStats();
+		return Item;
+	}
+
+	// Pool is empty; spawn a new item
+	AItem* Item{ GetWorld()->SpawnActorDeferred<AItem>(ItemClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn) };
+	if (Item)
+	{
+		InitItem(Item);
+		Item->FinishSpawning(Transform);
+
+		Stats.FallbackSpawns++;
+		INC_DWORD_STAT(STAT_ItemPoolFallbackSpawns);
+		UpdateStats();
+	}
+	return Item;
+}
+
+void UItemPoolSubsystem::ReleaseItem(AItem* Item)
+{
+	if (!IsValid(Item)) return;
+
+	DeactivateItem(Item);
+	ActiveItems.Remove(Item);
+	Pools.FindOrAdd(Item->GetClass()).FreeItems.AddUnique(Item);
+
+	Stats.Releases++;
+	UpdateStats();
+}
+
+void UItemPoolSubsystem::Prewarm(TSubclassOf<AItem> ItemClass, int32 Count)
+{
+	if (ItemClass == nullptr) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	while (Pools.FindOrAdd(ItemClass).FreeItems.Num() < Count)
+	{
+		AItem* Item{ GetWorld()->SpawnActor<AItem>(ItemClass, FTransform::Identity, SpawnParams) };
+		if (Item == nullptr) return;
+
+		DeactivateItem(Item);
+		ActiveItems.Remove(Item);
+		Pools.FindOrAdd(ItemClass).FreeItems.Add(Item);
+	}
+	UpdateStats();
+}
+
+void UItemPoolSubsystem::AddExpectedDrops(TSubclassOf<AItem> ItemClass, float Count)
+{
+	if (ItemClass == nullptr) return;
+
+	float& Expected{ ExpectedDrops.FindOrAdd(ItemClass) };
+	Expected = FMath::Max(Expected + Count, 0.f);
+
+	// Every enemy in play may die at once; items already pooled are kept when enemies leave
+	Prewarm(ItemClass, FMath::Min(FMath::CeilToInt(Expected), MaxPrewarmPerClass));
+}
+
+void UItemPoolSubsystem::RegisterActiveItem(AItem* Item)
+{
+	ActiveItems.Add(Item);
+	UpdateStats();
+}
+
+void UItemPoolSubsystem::UnregisterItem(AItem* Item)
+{
+	ActiveItems.Remove(Item);
+	if (FItemPool* Pool = Pools.Find(Item->GetClass()))
+	{
+		Pool->FreeItems.RemoveSwap(Item);
+	}
+	UpdateStats();
+}
+
+void UItemPoolSubsystem::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Item pool: %d active, %d pooled, %d pooled acquires, %d fallback spawns, %d releases"),
+		Stats.ActiveItems,
+		Stats.FreeItems,
+		Stats.PooledAcquires,
+		Stats.FallbackSpawns,
+		Stats.Releases);
+
+	for (const auto& PoolPair : Pools)
+	{
+		int32 ActiveOfClass{ 0 };
+		for (const AItem* Item : ActiveItems)
+		{
+			if (Item && Item->GetClass() == PoolPair.Key)
+			{
+				ActiveOfClass++;
+			}
+		}
+		const float* Expected{ ExpectedDrops.Find(PoolPair.Key) };
+		UE_LOG(LogTemp, Log, TEXT("  %s: %d active, %d pooled, %.1f expected drops"),
+			*GetNameSafe(PoolPair.Key),
+			ActiveOfClass,
+			PoolPair.Value.FreeItems.Num(),
+			Expected ? *Expected : 0.f);
+	}
+}
+
+void UItemPoolSubsystem::DeactivateItem(AItem* Item)
+{
+	Item->GetWorldTimerManager().ClearAllTimersForObject(Item);
+	Item->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Item->SetActorHiddenInGame(true);
+	Item->SetActorEnableCollision(false);
+	Item->SetActorTickEnabled(false);
+}
+
+void UItemPoolSubsystem::UpdateStats()
+{
+	Stats.ActiveItems = ActiveItems.Num();
+	Stats.FreeItems = 0;
+	for (const auto& PoolPair : Pools)
+	{
+		Stats.FreeItems += PoolPair.Value.FreeItems.Num();
+	}
+
+	SET_DWORD_STAT(STAT_ActiveItems, Stats.ActiveItems);
+	SET_DWORD_STAT(STAT_PooledItems, Stats.FreeItems);
+}
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Item.h"
+#include "ItemPoolSubsystem.generated.h"
+
+/** Inactive items of one class, ready to be acquired */
+USTRUCT()
+struct FItemPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AItem*> FreeItems;
+};
+
+/** Pool occupancy and allocation counters */
+struct FItemPoolStats
+{
+	/** Items currently in the world */
+	int32 ActiveItems = 0;
+	/** Items waiting in the pools */
+	int32 FreeItems = 0;
+	/** Acquires served from a pool */
+	int32 PooledAcquires = 0;
+	/** Acquires that had to spawn because the pool was empty */
+	int32 FallbackSpawns = 0;
+	/** Items returned to a pool */
+	int32 Releases = 0;
+};
+
+/**
+ * Recycles item actors so spawning and despawning items does not pay for actor
+ * construction, component registration and garbage collection.
+ * Spawn and despawn of items become AcquireItem and ReleaseItem.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UItemPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemPoolSubsystem();
+
+	/**
+	* Takes an inactive item of ItemClass from the pool, or spawns one if the pool is empty.
+	* InitItem runs before the item is placed in the world (rarity, item count, etc.)
+	*/
+	AItem* AcquireItem(TSubclassOf<AItem> ItemClass, const FTransform& Transform, TFunctionRef<void(AItem*)> InitItem);
+
+	template<class T>
+	T* AcquireItem(TSubclassOf<T> ItemClass, const FTransform& Transform)
+	{
+		return Cast<T>(AcquireItem(ItemClass, Transform, [](AItem*) {}));
+	}
+
+	/** Deactivates Item and returns it to the pool */
+	void ReleaseItem(AItem* Item);
+
+	/** Spawns inactive items until the pool for ItemClass holds at least Count */
+	void Prewarm(TSubclassOf<AItem> ItemClass, int32 Count);
+
+	/**
+	* Adds Count to the drops of ItemClass expected from the enemies in play and prewarms
+	* the pool to cover them, up to MaxPrewarmPerClass. Negative when enemies leave play
+	*/
+	void AddExpectedDrops(TSubclassOf<AItem> ItemClass, float Count);
+
+	/** Called from AItem::BeginPlay so items placed in the level are tracked too */
+	void RegisterActiveItem(AItem* Item);
+
+	/** Called from AItem::EndPlay */
+	void UnregisterItem(AItem* Item);
+
+	/** Returns the items currently in the world */
+	FORCEINLINE const TSet<AItem*>& GetActiveItems() const { return ActiveItems; }
+
+	FORCEINLINE const FItemPoolStats& GetStats() const { return Stats; }
+
+	/** Logs occupancy per class and the allocation counters */
+	void LogReport() const;
+
+private:
+	/** Hides the item and turns off its collision and tick */
+	static void DeactivateItem(AItem* Item);
+
+	/** Updates the free item count and the stat counters */
+	void UpdateStats();
+
+	/** Most items of one class spawned ahead of time for expected drops */
+	UPROPERTY(Config)
+	int32 MaxPrewarmPerClass;
+
+	/** Drops expected from the enemies in play, by class */
+	UPROPERTY()
+	TMap<UClass*, float> ExpectedDrops;
+
+	/** Inactive items, by class */
+	UPROPERTY()
+	TMap<UClass*, FItemPool> Pools;
+
+	/** Items currently in the world */
+	UPROPERTY()
+	TSet<AItem*> ActiveItems;
+
+	FItemPoolStats Stats;
+};
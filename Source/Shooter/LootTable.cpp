@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootTable.h"
+
+void FAliasTable::Build(TArrayView<const float> Weights)
+{
+	Probabilities.Reset();
+	Aliases.Reset();
+
+	const int32 Count{ Weights.Num() };
+	float WeightSum{ 0.f };
+	for (const float Weight : Weights)
+	{
+		WeightSum += FMath::Max(Weight, 0.f);
+	}
+	if (Count == 0 || WeightSum <= 0.f) return;
+
+	Probabilities.SetNumUninitialized(Count);
+	Aliases.SetNumUninitialized(Count);
+
+	// Scale weights so the average column holds exactly 1
+	TArray<float, TInlineAllocator<16>> Scaled;
+	TArray<int32, TInlineAllocator<16>> Small;
+	TArray<int32, TInlineAllocator<16>> Large;
+	Scaled.SetNumUninitialized(Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		Scaled[i] = FMath::Max(Weights[i], 0.f) * Count / WeightSum;
+		if (Scaled[i] < 1.f)
+		{
+			Small.Add(i);
+		}
+		else
+		{
+			Large.Add(i);
+		}
+	}
+
+	// Fill each under-full column with the remainder of an over-full one
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less{ Small.Pop(false) };
+		const int32 More{ Large.Pop(false) };
+
+		Probabilities[Less] = Scaled[Less];
+		Aliases[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.f;
+		if (Scaled[More] < 1.f)
+		{
+			Small.Add(More);
+		}
+		else
+		{
+			Large.Add(More);
+		}
+	}
+
+	// Leftovers are full columns; rounding can leave entries in either list
+	for (const int32 Index : Large)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+	for (const int32 Index : Small)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+}
+
+int32 FAliasTable::Sample() const
+{
+	if (IsEmpty()) return INDEX_NONE;
+
+	const int32 Column{ FMath::RandHelper(Probabilities.Num()) };
+	return FMath::FRand() < Probabilities[Column] ? Column : Aliases[Column];
+}
+
+void ULootTable::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildAliasTables();
+}
+
+#if WITH_EDITOR
+void ULootTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bAliasTablesBuilt = false;
+	BuildAliasTables();
+}
+#endif
+
+void ULootTable::BuildAliasTables() const
+{
+	if (bAliasTablesBuilt) return;
+	bAliasTablesBuilt = true;
+
+	TArray<float, TInlineAllocator<16>> Weights;
+	for (const FLootEntry& Entry : Entries)
+	{
+		Weights.Add(Entry.Weight);
+	}
+	EntryAliasTable.Build(Weights);
+
+	Weights.Reset();
+	for (int32 i = 0; i < (int32)EItemRarity::EIR_MAX; i++)
+	{
+		const float* Weight{ RarityWeights.Find((EItemRarity)i) };
+		Weights.Add(Weight ? *Weight : 0.f);
+	}
+	RarityAliasTable.Build(Weights);
+}
+
+float ULootTable::GetExpectedDropCount(const FLootEntry& Entry) const
+{
+	float WeightSum{ 0.f };
+	for (const FLootEntry& Other : Entries)
+	{
+		WeightSum += FMath::Max(Other.Weight, 0.f);
+	}
+	return WeightSum > 0.f ? NumRolls * FMath::Max(Entry.Weight, 0.f) / WeightSum : 0.f;
+}
+
+void ULootTable::RollLoot(TArray<FLootDrop>& OutDrops) const
+{
+	BuildAliasTables();
+
+	for (int32 Roll = 0; Roll < NumRolls; Roll++)
+	{
+		const int32 EntryIndex{ EntryAliasTable.Sample() };
+		if (EntryIndex == INDEX_NONE) return;
+
+		const FLootEntry& Entry{ Entries[EntryIndex] };
+		if (Entry.ItemClass == nullptr) continue;
+
+		const int32 RarityIndex{ RarityAliasTable.Sample() };
+
+		FLootDrop Drop;
+		Drop.ItemClass = Entry.ItemClass;
+		Drop.Rarity = RarityIndex == INDEX_NONE ? EItemRarity::EIR_Common : (EItemRarity)RarityIndex;
+		Drop.ItemCount = FMath::RandRange(Entry.MinItemCount, FMath::Max(Entry.MinItemCount, Entry.MaxItemCount));
+		OutDrops.Add(Drop);
+	}
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Item.h"
+#include "LootTable.generated.h"
+
+/**
+ * Alias method table (Vose) for sampling a weighted index in constant time.
+ * Building is O(N); each sample costs one random index and one random float.
+ */
+struct SHOOTER_API FAliasTable
+{
+	/** Builds the table from non-negative weights; an all-zero input leaves the table empty */
+	void Build(TArrayView<const float> Weights);
+
+	/** Returns a weighted random index, or INDEX_NONE if the table is empty */
+	int32 Sample() const;
+
+	FORCEINLINE bool IsEmpty() const { return Probabilities.Num() == 0; }
+
+private:
+	/** Probability of keeping column i rather than taking its alias */
+	TArray<float> Probabilities;
+
+	/** Alias taken from column i when the keep test fails */
+	TArray<int32> Aliases;
+};
+
+USTRUCT(BlueprintType)
+struct FLootEntry
+{
+	GENERATED_BODY()
+
+	/** Item to drop; None drops nothing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TSubclassOf<AItem> ItemClass;
+
+	/** Relative chance of this entry */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0"))
+	float Weight = 1.f;
+
+	/** Item count range (ammo, etc.) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 MinItemCount = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 MaxItemCount = 0;
+};
+
+/** Result of one loot roll */
+struct FLootDrop
+{
+	TSubclassOf<AItem> ItemClass;
+	EItemRarity Rarity;
+	int32 ItemCount;
+};
+
+/**
+ * Weighted loot for an enemy class. Rolls the item class, rarity and item count
+ * with alias tables that are built once from the weights.
+ */
+UCLASS(BlueprintType)
+class SHOOTER_API ULootTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Appends NumRolls drops to OutDrops; entries without an item class drop nothing */
+	void RollLoot(TArray<FLootDrop>& OutDrops) const;
+
+	FORCEINLINE const TArray<FLootEntry>& GetEntries() const { return Entries; }
+
+	/** Average number of Entry's item dropped per death */
+	float GetExpectedDropCount(const FLootEntry& Entry) const;
+
+private:
+	/** Builds the alias tables if the weights changed since the last build */
+	void BuildAliasTables() const;
+
+	/** Possible drops */
+	UPROPERTY(EditAnywhere, Category = Loot)
+	TArray<FLootEntry> Entries;
+
+	/** Relative chance of each rarity; missing rarities never drop */
+	UPROPERTY(EditAnywhere, Category = Loot)
+	TMap<EItemRarity, float> RarityWeights;
+
+	/** Number of entries rolled per death */
+	UPROPERTY(EditAnywhere, Category = Loot, meta = (ClampMin = "0"))
+	int32 NumRolls = 1;
+
+	mutable FAliasTable EntryAliasTable;
+	mutable FAliasTable RarityAliasTable;
+	mutable bool bAliasTablesBuilt = false;
+};
@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathCacheSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "HAL/IConsoleManager.h"
+#include "Shooter.h"
+
+DECLARE_CYCLE_STAT(TEXT("Path Cache Find Path"), STAT_PathCacheFindPath, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Cache Hits"), STAT_PathCacheHits, STATGROUP_Shooter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Cache Misses"), STAT_PathCacheMisses, STATGROUP_Shooter);
+DECLARE_MEMORY_STAT(TEXT("Path Cache Memory"), STAT_PathCacheMemory, STATGROUP_Shooter);
+
+static FAutoConsoleCommandWithWorld PathCacheReportCommand(
+	TEXT("Shooter.PathCache.Report"),
+	TEXT("Logs the hit rate, number of paths and memory of the shared path cache"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UPathCacheSubsystem* PathCache = World ? World->GetSubsystem<UPathCacheSubsystem>() : nullptr)
+		{
+			PathCache->LogReport();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld PathCacheInvalidateCommand(
+	TEXT("Shooter.PathCache.Invalidate"),
+	TEXT("Forgets every path in the shared path cache"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UPathCacheSubsystem* PathCache = World ? World->GetSubsystem<UPathCacheSubsystem>() : nullptr)
+		{
+			PathCache->Invalidate();
+		}
+	}));
+
+UPathCacheSubsystem::UPathCacheSubsystem() :
+	MaxPaths(1024),
+	ProjectionExtent(50.f, 50.f, 250.f),
+	Hits(0),
+	Misses(0),
+	Evictions(0),
+	Invalidations(0)
+{
+
+}
+
+bool UPathCacheSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World{ Cast<UWorld>(Outer) };
+	return World && World->IsGameWorld();
+}
+
+void UPathCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Cached corridors may cross polygons that no longer exist once the navmesh is rebuilt
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &UPathCacheSubsystem::OnNavigationGenerationFinished);
+	}
+}
+
+void UPathCacheSubsystem::Deinitialize()
+{
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &UPathCacheSubsystem::OnNavigationGenerationFinished);
+	}
+	Paths.Empty();
+
+	Super::Deinitialize();
+}
+
+FNavPathSharedPtr UPathCacheSubsystem::FindPath(const FVector& Start, const FVector& End, const AAIController* Querier)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathCacheFindPath);
+
+	UNavigationSystemV1* NavSys{ FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()) };
+	ANavigationData* NavData{ NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr };
+	if (NavData == nullptr) return nullptr;
+
+	FNavLocation StartLocation;
+	FNavLocation EndLocation;
+	if (!NavData->ProjectPoint(Start, StartLocation, ProjectionExtent) ||
+		!NavData->ProjectPoint(End, EndLocation, ProjectionExtent))
+	{
+		return nullptr;
+	}
+
+	// The controller's default filter, as AAIController::MoveTo would use; areas it excludes change the corridor
+	const UClass* FilterClass{ Querier ? Querier->GetDefaultNavigationFilterClass().Get() : nullptr };
+	const FSharedConstNavQueryFilter Filter{ UNavigationQueryFilter::GetQueryFilter(*NavData, Querier, FilterClass) };
+
+	const float CurrentTime{ GetWorld()->GetTimeSeconds() };
+	const FPathCacheKey Key{ StartLocation.NodeRef, EndLocation.NodeRef, FilterClass };
+	if (FCachedPath* Entry = Paths.Find(Key))
+	{
+		Entry->LastUsedTime = CurrentTime;
+		const FNavPathSharedPtr CachedPath{ MakePath(*Entry, StartLocation, EndLocation, *NavData, Querier, Filter) };
+		if (CachedPath.IsValid())
+		{
+			Hits++;
+			INC_DWORD_STAT(STAT_PathCacheHits);
+			return CachedPath;
+		}
+		Paths.Remove(Key);
+	}
+
+	Misses++;
+	INC_DWORD_STAT(STAT_PathCacheMisses);
+
+	FPathFindingQuery Query(
+		Querier,
+		*NavData,
+		StartLocation.Location,
+		EndLocation.Location,
+		Filter);
+	const FPathFindingResult Result{ NavSys->FindPathSync(Query) };
+	if (!Result.IsSuccessful()) return nullptr;
+
+	// As AAIController::FindPathForMoveRequest does, so dynamic navmesh updates repath the move
+	Result.Path->EnableRecalculationOnInvalidation(true);
+
+	// Partial paths depend on where the search gave up, and off-mesh links on their own state
+	const FNavMeshPath* NavMeshPath{ Result.Path->CastPath<FNavMeshPath>() };
+	if (NavMeshPath && !Result.IsPartial() && NavMeshPath->GetCustomLinkIds().Num() == 0)
+	{
+		AddPath(Key, *NavMeshPath, CurrentTime);
+	}
+	return Result.Path;
+}
+
+void UPathCacheSubsystem::MoveToLocation(AAIController* Controller, const FVector& Destination, float AcceptanceRadius)
+{
+	const APawn* Pawn{ Controller ? Controller->GetPawn() : nullptr };
+	if (Pawn == nullptr) return;
+
+	FAIMoveRequest MoveRequest(Destination);
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+
+	const FNavPathSharedPtr Path{ FindPath(Pawn->GetNavAgentLocation(), Destination, Controller) };
+	if (Path.IsValid())
+	{
+		Controller->RequestMove(MoveRequest, Path);
+	}
+	else
+	{
+		Controller->MoveTo(MoveRequest);
+	}
+}
+
+FNavPathSharedPtr UPathCacheSubsystem::MakePath(const FCachedPath& Entry, const FNavLocation& Start, const FNavLocation& End, ANavigationData& NavData, const AAIController* Querier, FSharedConstNavQueryFilter Filter) const
+{
+	TSharedRef<FNavMeshPath, ESPMode::ThreadSafe> Path{ MakeShared<FNavMeshPath, ESPMode::ThreadSafe>() };
+	Path->PathCorridor = Entry.PathCorridor;
+	Path->PathCorridorCost = Entry.PathCorridorCost;
+	Path->SetNavigationDataUsed(&NavData);
+
+	// Only the corridor is shared; the corners depend on where in the end polygons the path starts and ends
+	Path->PerformStringPulling(Start.Location, End.Location);
+	if (Path->GetPathPoints().Num() < 2) return nullptr;
+
+	// The navmesh registers the path for invalidation once it is marked ready; a repath searches with Filter
+	Path->SetQuerier(Querier);
+	Path->SetFilter(Filter);
+	Path->SetTimeStamp(NavData.GetWorldTimeStamp());
+	Path->EnableRecalculationOnInvalidation(true);
+	Path->MarkReady();
+	return Path;
+}
+
+void UPathCacheSubsystem::AddPath(const FPathCacheKey& Key, const FNavMeshPath& Path, float CurrentTime)
+{
+	if (MaxPaths <= 0 || Path.PathCorridor.Num() == 0) return;
+
+	if (Paths.Num() >= MaxPaths)
+	{
+		// A linear scan; only paid on a miss with a full cache
+		FPathCacheKey OldestKey{ Key };
+		float OldestTime{ TNumericLimits<float>::Max() };
+		for (const TPair<FPathCacheKey, FCachedPath>& Pair : Paths)
+		{
+			if (Pair.Value.LastUsedTime < OldestTime)
+			{
+				OldestKey = Pair.Key;
+				OldestTime = Pair.Value.LastUsedTime;
+			}
+		}
+		Paths.Remove(OldestKey);
+		Evictions++;
+	}
+
+	FCachedPath& Entry{ Paths.Add(Key) };
+	Entry.PathCorridor = Path.PathCorridor;
+	Entry.PathCorridorCost = Path.PathCorridorCost;
+	Entry.LastUsedTime = CurrentTime;
+
+	SET_MEMORY_STAT(STAT_PathCacheMemory, GetAllocatedSize());
+}
+
+void UPathCacheSubsystem::Invalidate()
+{
+	Paths.Reset();
+	Invalidations++;
+
+	SET_MEMORY_STAT(STAT_PathCacheMemory, GetAllocatedSize());
+}
+
+SIZE_T UPathCacheSubsystem::GetAllocatedSize() const
+{
+	SIZE_T Size{ Paths.GetAllocatedSize() };
+	for (const TPair<FPathCacheKey, FCachedPath>& Pair : Paths)
+	{
+		Size += Pair.Value.PathCorridor.GetAllocatedSize();
+		Size += Pair.Value.PathCorridorCost.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void UPathCacheSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	Invalidate();
+}
+
+void UPathCacheSubsystem::LogReport() const
+{
+	const int32 Lookups{ Hits + Misses };
+	UE_LOG(LogTemp, Log, TEXT("%d of %d paths cached, %.1f KB; %d hits, %d misses (%.1f%% hit rate), %d evictions, %d invalidations"),
+		Paths.Num(),
+		MaxPaths,
+		GetAllocatedSize() / 1024.f,
+		Hits,
+		Misses,
+		Lookups > 0 ? 100.f * Hits / Lookups : 0.f,
+		Evictions,
+		Invalidations);
+}
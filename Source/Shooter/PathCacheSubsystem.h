@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationSystemTypes.h"
+#include "NavMesh/NavMeshPath.h"
+#include "PathCacheSubsystem.generated.h"
+
+class AAIController;
+class ANavigationData;
+
+/** Start polygon, end polygon and navigation filter class of a cached path; a null class is the navmesh's default filter */
+using FPathCacheKey = TTuple<NavNodeRef, NavNodeRef, const UClass*>;
+
+/** The polygon corridor of a navmesh path found between two polygons */
+struct FCachedPath
+{
+	TArray<NavNodeRef> PathCorridor;
+	TArray<float> PathCorridorCost;
+
+	/** World time of the last lookup; the least recently used path is evicted first */
+	float LastUsedTime = 0.f;
+};
+
+/**
+ * Shares navmesh paths between enemies. The corridors of complete paths are
+ * kept by their start and end polygons; a later request between the same two
+ * polygons string-pulls its own start and end points through the cached
+ * corridor instead of running A* again, so repeated patrol legs and common
+ * destinations are searched once. Paths found with different navigation
+ * filters are kept apart. The cache is cleared whenever the navmesh is rebuilt;
+ * paths already handed out repath themselves when their polygons change.
+ */
+UCLASS(Config = Game)
+class SHOOTER_API UPathCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPathCacheSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Path from Start to End on the default navmesh, from the cache if possible. Null when there is none */
+	FNavPathSharedPtr FindPath(const FVector& Start, const FVector& End, const AAIController* Querier);
+
+	/** Moves Controller's pawn to Destination along a cached path, or a regular move request if none is found */
+	void MoveToLocation(AAIController* Controller, const FVector& Destination, float AcceptanceRadius);
+
+	/** Forgets every cached path */
+	void Invalidate();
+
+	/** Bytes held by the cached paths and the cache map */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Logs the hit rate, number of paths and memory of the cache */
+	void LogReport() const;
+
+private:
+	/** Builds a path for Start and End through the corridor of Entry, which begins and ends in their polygons. Null if string pulling fails */
+	FNavPathSharedPtr MakePath(const FCachedPath& Entry, const FNavLocation& Start, const FNavLocation& End, ANavigationData& NavData, const AAIController* Querier, FSharedConstNavQueryFilter Filter) const;
+
+	void AddPath(const FPathCacheKey& Key, const FNavMeshPath& Path, float CurrentTime);
+
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	/** Paths kept; the least recently used one is evicted when full */
+	UPROPERTY(Config)
+	int32 MaxPaths;
+
+	/** How far from the navmesh start and end points are projected */
+	UPROPERTY(Config)
+	FVector ProjectionExtent;
+
+	/** Paths by start and end polygon and filter class */
+	TMap<FPathCacheKey, FCachedPath> Paths;
+
+	int32 Hits;
+	int32 Misses;
+	int32 Evictions;
+	int32 Invalidations;
+};
@@ -1,5 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
+using System.IO;
+using EpicGames.Core;
 using UnrealBuildTool;
 
 public class Shooter : ModuleRules
@@ -8,10 +10,18 @@ public class Shooter : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "UMG", "PhysicsCore", "NavigationSystem", "AIModule" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "UMG", "PhysicsCore", "NavigationSystem", "AIModule", "GameplayTasks" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
+		// Written by UShooterTuningCommandlet; see ShooterTuning.h
+		bool bHasGeneratedTuning = File.Exists(Path.Combine(ModuleDirectory, "Generated", "ShooterTuningTables.h"));
+		PublicDefinitions.Add("SHOOTER_GENERATED_TUNING=" + (bHasGeneratedTuning ? "1" : "0"));
+		if (!bHasGeneratedTuning && Target.Type != TargetType.Editor)
+		{
+			Log.TraceWarning("Generated/ShooterTuningTables.h is missing; {0} reads the runtime tuning tables. Run UE4Editor-Cmd Shooter.uproject -run=ShooterTuning to compile them in", Target.Name);
+		}
+
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
 
@@ -23,6 +23,11 @@
 #include "Enemy.h"
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "Curves/CurveFloat.h"
+#include "ItemPoolSubsystem.h"
+#include "ItemDefinitionSubsystem.h"
+#include "WeaponDefinition.h"
+#include "AttackTokenComponent.h"
 
 // Sets default values
 AShooterCharacter::AShooterCharacter() :
@@ -62,6 +67,8 @@ AShooterCharacter::AShooterCharacter() :
 	// Camera interp location variables
 	CameraInterpDistance(250.f),
 	CameraInterpElevation(65.f),
+	InterpLocationColumnSpacing(80.f),
+	InterpLocationRowSpacing(60.f),
 	// Starting ammo amounts
 	Starting9mmAmmo(85),
 	StartingARAmmo(120),
@@ -116,27 +123,7 @@ AShooterCharacter::AShooterCharacter() :
 	// Create Hand Scene Component 
 	HandSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("HandSceneComp"));
 
-	// Create Interpolation Components
-	WeaponInterpComp = CreateDefaultSubobject<USceneComponent>(TEXT("Weapon Interpolation Component"));
-	WeaponInterpComp->SetupAttachment(GetFollowCamera());
-
-	InterpComp1 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 1"));
-	InterpComp1->SetupAttachment(GetFollowCamera());
-
-	InterpComp2 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 2"));
-	InterpComp2->SetupAttachment(GetFollowCamera());
-
-	InterpComp3 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 3"));
-	InterpComp3->SetupAttachment(GetFollowCamera());
-
-	InterpComp4 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 4"));
-	InterpComp4->SetupAttachment(GetFollowCamera());
-
-	InterpComp5 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 5"));
-	InterpComp5->SetupAttachment(GetFollowCamera());
-
-	InterpComp6 = CreateDefaultSubobject<USceneComponent>(TEXT("Interpolation Component 6"));
-	InterpComp6->SetupAttachment(GetFollowCamera());
+	AttackTokens = CreateDefaultSubobject<UAttackTokenComponent>(TEXT("AttackTokens"));
 }
 
 float AShooterCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -195,13 +182,13 @@ void AShooterCharacter::BeginPlay()
 	}
 	// Spawn the default weapon and equip it
 	EquipWeapon(SpawnDefaultWeapon());
-	Inventory.Add(EquippedWeapon);
 	EquippedWeapon->SetSlotIndex(0);
+	Inventory.SetSlot(0, MakeInventoryRecord(EquippedWeapon));
 	EquippedWeapon->DisableCustomDepth();
 	EquippedWeapon->DisableGlowMaterial();
 	EquippedWeapon->SetCharacter(this);
 
-	InitializeAmmoMap();
+	InitializeAmmo();
 	GetCharacterMovement()->MaxWalkSpeed = BaseMovementSpeed;
 
 	// Create FInterpLocation structs for each interp location. Add to array
@@ -287,11 +274,8 @@ void AShooterCharacter::FireWeapon()
 
 		StartFireTimer();
 
-		if (EquippedWeapon->GetWeaponType() == EWeaponType::EWT_Pistol)
-		{
-			// Start moving slide timer
-			EquippedWeapon->StartSlideTimer();
-		}
+		// e.g. start moving the pistol slide
+		EquippedWeapon->GetBehavior().OnFired(*EquippedWeapon);
 	}
 }
 
@@ -477,7 +461,7 @@ void AShooterCharacter::AutoFireReset()
 	if (EquippedWeapon == nullptr) return;
 	if (WeaponHasAmmo())
 	{
-		if (bFireButtonPressed && EquippedWeapon->GetAutomatic())
+		if (bFireButtonPressed && EquippedWeapon->GetBehavior().ShouldRefire(*EquippedWeapon))
 		{
 			FireWeapon();
 		}
@@ -572,7 +556,7 @@ void AShooterCharacter::TraceForItems()
 				TraceHitItem->GetPickupWidget()->SetVisibility(true);
 				TraceHitItem->EnableCustomDepth();
 
-				if (Inventory.Num() >= INVENTORY_CAPACITY)
+				if (Inventory.IsFull())
 				{
 					// Inventory is full
 					TraceHitItem->SetCharacterInventoryFull(true);
@@ -613,8 +597,9 @@ AWeapon* AShooterCharacter::SpawnDefaultWeapon()
 	// Check the TSubclassOf variable
 	if (DefaultWeaponClass)
 	{
-		// Spawn the Weapon
-		return GetWorld()->SpawnActor<AWeapon>(DefaultWeaponClass);
+		// Take the Weapon from the item pool
+		UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>();
+		return ItemPool ? ItemPool->AcquireItem<AWeapon>(DefaultWeaponClass, FTransform::Identity) : nullptr;
 	}
 
 	return nullptr;
@@ -658,6 +643,7 @@ void AShooterCharacter::DropWeapon()
 		EquippedWeapon->GetItemMesh()->DetachFromComponent(DetachmentTransformRules);
 
 		EquippedWeapon->SetItemState(EItemState::EIS_Falling);
+		EquippedWeapon->SetPlayerDropped(true);
 		EquippedWeapon->ThrowWeapon();
 	}
 }
@@ -679,9 +665,9 @@ void AShooterCharacter::SelectButtonReleased()
 void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 {
 
-	if (Inventory.Num() - 1 >= EquippedWeapon->GetSlotIndex())
+	if (Inventory.IsOccupied(EquippedWeapon->GetSlotIndex()))
 	{
-		Inventory[EquippedWeapon->GetSlotIndex()] = WeaponToSwap;
+		Inventory.SetSlot(EquippedWeapon->GetSlotIndex(), MakeInventoryRecord(WeaponToSwap));
 		WeaponToSwap->SetSlotIndex(EquippedWeapon->GetSlotIndex());
 	}
 
@@ -691,10 +677,10 @@ void AShooterCharacter::SwapWeapon(AWeapon* WeaponToSwap)
 	TraceHitItemLastFrame = nullptr;
 }
 
-void AShooterCharacter::InitializeAmmoMap()
+void AShooterCharacter::InitializeAmmo()
 {
-	AmmoMap.Add(EAmmoType::EAT_9mm, Starting9mmAmmo);
-	AmmoMap.Add(EAmmoType::EAT_AR, StartingARAmmo);
+	Inventory.GetAmmo(EAmmoType::EAT_9mm) = Starting9mmAmmo;
+	Inventory.GetAmmo(EAmmoType::EAT_AR) = StartingARAmmo;
 }
 
 bool AShooterCharacter::WeaponHasAmmo()
@@ -844,14 +830,7 @@ bool AShooterCharacter::CarryingAmmo()
 {
 	if (EquippedWeapon == nullptr) return false;
 
-	auto AmmoType = EquippedWeapon->GetAmmoType();
-
-	if (AmmoMap.Contains(AmmoType))
-	{
-		return AmmoMap[AmmoType] > 0;
-	}
-
-	return false;
+	return Inventory.GetAmmo(EquippedWeapon->GetAmmoType()) > 0;
 }
 
 void AShooterCharacter::GrabClip()
@@ -945,15 +924,8 @@ void AShooterCharacter::StopAiming()
 
 void AShooterCharacter::PickupAmmo(AAmmo* Ammo)
 {
-	// check to see if AmmoMap contains Ammo's AmmoType
-	if (AmmoMap.Find(Ammo->GetAmmoType()))
-	{
-		// Get amount of ammo in our AmmoMap for Ammo's type
-		int32 AmmoCount{ AmmoMap[Ammo->GetAmmoType()] };
-		AmmoCount += Ammo->GetItemCount();
-		// Set the amount of ammo in the Map for this type
-		AmmoMap[Ammo->GetAmmoType()] = AmmoCount;
-	}
+	// Add the Ammo's count to the carried ammo for its type
+	Inventory.GetAmmo(Ammo->GetAmmoType()) += Ammo->GetItemCount();
 
 	if (EquippedWeapon->GetAmmoType() == Ammo->GetAmmoType())
 	{
@@ -964,31 +936,116 @@ void AShooterCharacter::PickupAmmo(AAmmo* Ammo)
 		}
 	}
 
-	Ammo->Destroy();
+	// Return the Ammo to the item pool
+	if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+	{
+		ItemPool->ReleaseItem(Ammo);
+	}
+	else
+	{
+		Ammo->Destroy();
+	}
 }
 
 void AShooterCharacter::InitializeInterpLocations()
 {
-	FInterpLocation WeaponLocation{ WeaponInterpComp, 0 };
-	InterpLocations.Add(WeaponLocation);
+	// Weapons fly to the first location; other items to two rows of three below it
+	InterpLocations.Reset(7);
+	InterpLocations.Add({ FVector(CameraInterpDistance, 0.f, CameraInterpElevation), 0 });
+	for (int32 Row = 0; Row < 2; Row++)
+	{
+		for (int32 Column = -1; Column <= 1; Column++)
+		{
+			InterpLocations.Add({ FVector(CameraInterpDistance, Column * InterpLocationColumnSpacing, Row * -InterpLocationRowSpacing), 0 });
+		}
+	}
+	InterpWorldLocations.SetNumZeroed(InterpLocations.Num());
+}
+
+void AShooterCharacter::StartItemFlight(AItem* Item)
+{
+	if (Item == nullptr || InterpLocations.Num() == 0) return;
+
+	// Weapons always fly to the first interp location
+	const int32 InterpLocIndex{ Item->GetItemType() == EItemType::EIT_Weapon ? 0 : Item->GetInterpLocIndex() };
+	const float CameraYaw{ GetFollowCamera()->GetComponentRotation().Yaw };
+
+	FlightItems.Add(Item);
+	FlightStartLocations.Add(Item->GetActorLocation());
+	FlightLocations.Add(Item->GetActorLocation());
+	FlightElapsedTimes.Add(0.f);
+	FlightDurations.Add(Item->GetZCurveTime());
+	// Initial Yaw offset between Camera and Item
+	FlightYawOffsets.Add(Item->GetActorRotation().Yaw - CameraYaw);
+	FlightInterpLocIndices.Add(FMath::Clamp(InterpLocIndex, 0, InterpLocations.Num() - 1));
+}
+
+void AShooterCharacter::UpdateItemFlights(float DeltaTime)
+{
+	if (FlightItems.Num() == 0) return;
+
+	// Interp locations and camera yaw for this frame, shared by every flying item
+	const FTransform CameraTransform{ GetFollowCamera()->GetComponentTransform() };
+	for (int32 i = 0; i < InterpLocations.Num(); i++)
+	{
+		InterpWorldLocations[i] = CameraTransform.TransformPosition(InterpLocations[i].CameraOffset);
+	}
+	const float CameraYaw{ CameraTransform.Rotator().Yaw };
+
+	TArray<AItem*, TInlineAllocator<8>> FinishedItems;
+	for (int32 i = FlightItems.Num() - 1; i >= 0; i--)
+	{
+		AItem* Item{ FlightItems[i] };
+		FlightElapsedTimes[i] += DeltaTime;
+		const float ElapsedTime{ FMath::Min(FlightElapsedTimes[i], FlightDurations[i]) };
+
+		if (Item)
+		{
+			const FVector& StartLocation{ FlightStartLocations[i] };
+			const FVector& TargetLocation{ InterpWorldLocations[FlightInterpLocIndices[i]] };
+			FVector& ItemLocation{ FlightLocations[i] };
 
-	FInterpLocation InterpLoc1{ InterpComp1, 0 };
-	InterpLocations.Add(InterpLoc1);
+			// Interpolate X and Y toward the interp location
+			ItemLocation.X = FMath::FInterpTo(ItemLocation.X, TargetLocation.X, DeltaTime, 30.f);
+			ItemLocation.Y = FMath::FInterpTo(ItemLocation.Y, TargetLocation.Y, DeltaTime, 30.f);
 
-	FInterpLocation InterpLoc2{ InterpComp2, 0 };
-	InterpLocations.Add(InterpLoc2);
+			// Z follows the curve, scaled by the height difference to the interp location
+			const UCurveFloat* ZCurve{ Item->GetItemZCurve() };
+			const float CurveValue{ ZCurve ? ZCurve->GetFloatValue(ElapsedTime) : ElapsedTime / FlightDurations[i] };
+			ItemLocation.Z = StartLocation.Z + CurveValue * FMath::Abs(TargetLocation.Z - StartLocation.Z);
 
-	FInterpLocation InterpLoc3{ InterpComp3, 0 };
-	InterpLocations.Add(InterpLoc3);
+			// Camera rotation plus initial Yaw offset
+			const FRotator ItemRotation{ 0.f, CameraYaw + FlightYawOffsets[i], 0.f };
+			Item->SetActorLocationAndRotation(ItemLocation, ItemRotation, false, nullptr, ETeleportType::TeleportPhysics);
 
-	FInterpLocation InterpLoc4{ InterpComp4, 0 };
-	InterpLocations.Add(InterpLoc4);
+			if (const UCurveFloat* ScaleCurve = Item->GetItemScaleCurve())
+			{
+				Item->SetActorScale3D(FVector(ScaleCurve->GetFloatValue(ElapsedTime)));
+			}
+			Item->SetInterpElapsedTime(ElapsedTime);
+		}
 
-	FInterpLocation InterpLoc5{ InterpComp5, 0 };
-	InterpLocations.Add(InterpLoc5);
+		if (Item == nullptr || FlightElapsedTimes[i] >= FlightDurations[i])
+		{
+			if (Item)
+			{
+				FinishedItems.Add(Item);
+			}
+			FlightItems.RemoveAtSwap(i, 1, false);
+			FlightStartLocations.RemoveAtSwap(i, 1, false);
+			FlightLocations.RemoveAtSwap(i, 1, false);
+			FlightElapsedTimes.RemoveAtSwap(i, 1, false);
+			FlightDurations.RemoveAtSwap(i, 1, false);
+			FlightYawOffsets.RemoveAtSwap(i, 1, false);
+			FlightInterpLocIndices.RemoveAtSwap(i, 1, false);
+		}
+	}
 
-	FInterpLocation InterpLoc6{ InterpComp6, 0 };
-	InterpLocations.Add(InterpLoc6);
+	// Finishing can equip or swap weapons, so do it after the arrays are updated
+	for (AItem* Item : FinishedItems)
+	{
+		Item->FinishInterping();
+	}
 }
 
 void AShooterCharacter::FKeyPressed()
@@ -1031,7 +1088,7 @@ void AShooterCharacter::ExchangeInventoryItems(int32 CurrentItemIndex, int32 New
 {
 	const bool bCanExchangeItems = 
 		(CurrentItemIndex != NewItemIndex) &&
-		(NewItemIndex < Inventory.Num()) &&
+		Inventory.IsOccupied(NewItemIndex) &&
 		(CombatState == ECombatState::ECS_Unoccupied || CombatState == ECombatState::ECS_Equipping);
 
 	if (bCanExchangeItems)
@@ -1041,12 +1098,18 @@ void AShooterCharacter::ExchangeInventoryItems(int32 CurrentItemIndex, int32 New
 			StopAiming();
 		}
 
+		auto NewWeapon = MaterializeInventoryWeapon(NewItemIndex);
+		if (NewWeapon == nullptr) return;
+
+		// Keep the old weapon's magazine in its record; only the equipped weapon stays an actor
 		auto OldEquippedWeapon = EquippedWeapon;
-		auto NewWeapon = Cast<AWeapon>(Inventory[NewItemIndex]);
+		Inventory.SetSlot(CurrentItemIndex, MakeInventoryRecord(OldEquippedWeapon));
 		EquipWeapon(NewWeapon);
 
-		OldEquippedWeapon->SetItemState(EItemState::EIS_PickedUp);
-		NewWeapon->SetItemState(EItemState::EIS_Equipped);
+		if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+		{
+			ItemPool->ReleaseItem(OldEquippedWeapon);
+		}
 
 		CombatState = ECombatState::ECS_Equipping;
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -1059,21 +1122,113 @@ void AShooterCharacter::ExchangeInventoryItems(int32 CurrentItemIndex, int32 New
 	}
 }
 
-int32 AShooterCharacter::GetEmptyInventorySlot()
+FInventoryRecord AShooterCharacter::MakeInventoryRecord(const AWeapon* Weapon)
 {
-	for (int32 i = 0; i < Inventory.Num(); i++)
+	FInventoryRecord Record;
+	if (UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(Weapon))
 	{
-		if (Inventory[i] == nullptr)
+		Record.WeaponClassPath = ItemDefinitions->GetWeaponClassPath(Weapon->GetClass());
+
+		// Attachments outlive the pooled actor as names; ResetItem clears them from the actor
+		for (const FWeaponModifier& Modifier : Weapon->GetModifiers())
 		{
-			return i;
+			if (Record.NumModifiers == MaxWeaponModifiers) break;
+			ItemDefinitions->RegisterWeaponModifier(Modifier);
+			Record.ModifierNames[Record.NumModifiers++] = Modifier.ModifierName;
 		}
 	}
-	if (Inventory.Num() < INVENTORY_CAPACITY)
+	Record.WeaponType = Weapon->GetWeaponType();
+	Record.Ammo = Weapon->GetAmmo();
+	Record.ItemRarity = Weapon->GetItemRarity();
+	return Record;
+}
+
+AWeapon* AShooterCharacter::MaterializeInventoryWeapon(int32 SlotIndex)
+{
+	UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>();
+	if (ItemPool == nullptr || !Inventory.IsOccupied(SlotIndex)) return nullptr;
+
+	// Blueprint subclasses carry per-type settings such as the pistol slide, so respawn the recorded class
+	const FInventoryRecord& Record{ Inventory.Slots[SlotIndex] };
+	UItemDefinitionSubsystem* ItemDefinitions{ UItemDefinitionSubsystem::Get(this) };
+	TSubclassOf<AWeapon> WeaponClass{ ItemDefinitions ? ItemDefinitions->GetWeaponClass(Record.WeaponClassPath) : nullptr };
+	if (WeaponClass == nullptr)
 	{
-		return Inventory.Num();
+		WeaponClass = DefaultWeaponClass;
 	}
-	
-	return -1; // Inventory is full!
+
+	TArray<FWeaponModifier> Modifiers;
+	for (int32 Index = 0; ItemDefinitions && Index < Record.NumModifiers; ++Index)
+	{
+		if (const FWeaponModifier* Modifier = ItemDefinitions->GetWeaponModifier(Record.ModifierNames[Index]))
+		{
+			Modifiers.Add(*Modifier);
+		}
+	}
+
+	AWeapon* Weapon = Cast<AWeapon>(ItemPool->AcquireItem(WeaponClass, GetActorTransform(), [&Record, &Modifiers](AItem* Item)
+	{
+		AWeapon* PooledWeapon = CastChecked<AWeapon>(Item);
+		PooledWeapon->SetWeaponType(Record.WeaponType);
+		PooledWeapon->SetItemRarity(Record.ItemRarity);
+		// Before the recorded ammo, which may only fit an extended magazine
+		PooledWeapon->SetModifiers(MoveTemp(Modifiers));
+	}));
+	if (Weapon == nullptr) return nullptr;
+
+	// Construction refills the magazine; restore the recorded ammo afterwards
+	Weapon->SetAmmo(Record.Ammo);
+	Weapon->SetSlotIndex(SlotIndex);
+	Weapon->SetCharacter(this);
+	Weapon->DisableCustomDepth();
+	Weapon->DisableGlowMaterial();
+	return Weapon;
+}
+
+FInventoryRecord AShooterCharacter::GetInventoryRecord(int32 SlotIndex) const
+{
+	if (!Inventory.IsOccupied(SlotIndex)) return FInventoryRecord();
+
+	if (EquippedWeapon && EquippedWeapon->GetSlotIndex() == SlotIndex)
+	{
+		return MakeInventoryRecord(EquippedWeapon);
+	}
+	return Inventory.Slots[SlotIndex];
+}
+
+UTexture2D* AShooterCharacter::GetInventoryIcon(int32 SlotIndex) const
+{
+	if (!Inventory.IsOccupied(SlotIndex)) return nullptr;
+
+	const FInventoryRecord Record{ GetInventoryRecord(SlotIndex) };
+	const UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this);
+	const UWeaponDefinition* Definition = ItemDefinitions ? ItemDefinitions->GetWeaponDefinition(Record.WeaponType) : nullptr;
+	return Definition ? Definition->InventoryIcon.Get() : nullptr;
+}
+
+UTexture2D* AShooterCharacter::GetInventoryAmmoIcon(int32 SlotIndex) const
+{
+	if (!Inventory.IsOccupied(SlotIndex)) return nullptr;
+
+	const FInventoryRecord Record{ GetInventoryRecord(SlotIndex) };
+	const UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this);
+	const UWeaponDefinition* Definition = ItemDefinitions ? ItemDefinitions->GetWeaponDefinition(Record.WeaponType) : nullptr;
+	return Definition ? Definition->AmmoIcon.Get() : nullptr;
+}
+
+UTexture2D* AShooterCharacter::GetInventoryIconBackground(int32 SlotIndex) const
+{
+	if (!Inventory.IsOccupied(SlotIndex)) return nullptr;
+
+	const FInventoryRecord Record{ GetInventoryRecord(SlotIndex) };
+	const UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this);
+	return ItemDefinitions ? ItemDefinitions->GetRarityIconBackground(Record.ItemRarity) : nullptr;
+}
+
+int32 AShooterCharacter::GetEmptyInventorySlot()
+{
+	// -1 (INDEX_NONE) when the Inventory is full
+	return Inventory.FindEmptySlot();
 }
 
 void AShooterCharacter::HighlightInventorySlot()
@@ -1160,6 +1315,8 @@ void AShooterCharacter::Tick(float DeltaTime)
 	TraceForItems();
 	// Interpolate the capsule half height based on crouching/standing
 	InterpCapsuleHalfHeight(DeltaTime);
+	// Move picked up items toward their interp locations
+	UpdateItemFlights(DeltaTime);
 }
 
 // Called to bind functionality to input
@@ -1229,32 +1386,14 @@ void AShooterCharacter::FinishReloading()
 	if (EquippedWeapon == nullptr) return;
 	const auto AmmoType{ EquippedWeapon->GetAmmoType() };
 
-	// Update the AmmoMap
-	if (AmmoMap.Contains(AmmoType))
-	{
-		// Amount of ammo the Character is carrying of the EquippedWeapon type
-		int32 CarriedAmmo = AmmoMap[AmmoType];
+	// Amount of ammo the Character is carrying of the EquippedWeapon type
+	int32& CarriedAmmo = Inventory.GetAmmo(AmmoType);
 
-		// Space left in the magazine of EquippedWeapon
-		const int32 MagEmptySpace = 
-			EquippedWeapon->GetMagazineCapacity() - 
-			EquippedWeapon->GetAmmo();
+	// Rounds to move into the magazine; a full magazine or one round depending on the weapon
+	const int32 ReloadAmount{ EquippedWeapon->GetBehavior().GetReloadAmount(*EquippedWeapon, CarriedAmmo) };
 
-		if (MagEmptySpace > CarriedAmmo)
-		{
-			// Reload the magazine with all the ammo we are carrying
-			EquippedWeapon->ReloadAmmo(CarriedAmmo);
-			CarriedAmmo = 0;
-			AmmoMap.Add(AmmoType, CarriedAmmo);
-		}
-		else
-		{
-			// fill the magazine
-			EquippedWeapon->ReloadAmmo(MagEmptySpace);
-			CarriedAmmo -= MagEmptySpace;
-			AmmoMap.Add(AmmoType, CarriedAmmo);
-		}
-	}
+	EquippedWeapon->ReloadAmmo(ReloadAmount);
+	CarriedAmmo -= ReloadAmount;
 }
 
 void AShooterCharacter::FinishEquipping()
@@ -1297,16 +1436,6 @@ void AShooterCharacter::IncrementOverlappedItemCount(int8 Amount)
 	}
 }
 
-/* No longer needed; AItem has GetInterpLocation
-FVector AShooterCharacter::GetCameraInterpLocation()
-{
-	const FVector CameraWorldLocation{ FollowCamera->GetComponentLocation() };
-	const FVector CameraForward{ FollowCamera->GetForwardVector() };
-	// Desired = CameraWorldLocation + Forward * A + Up * B
-	return CameraWorldLocation + CameraForward * CameraInterpDistance
-		+ FVector(0.f, 0.f, CameraInterpElevation);
-}*/
-
 void AShooterCharacter::GetPickupItem(AItem* Item)
 {
 	Item->PlayEquipSound();
@@ -1314,11 +1443,21 @@ void AShooterCharacter::GetPickupItem(AItem* Item)
 	auto Weapon = Cast<AWeapon>(Item);
 	if (Weapon)
 	{
-		if (Inventory.Num() < INVENTORY_CAPACITY)
+		const int32 EmptySlot{ Inventory.FindEmptySlot() };
+		if (EmptySlot != INDEX_NONE)
 		{
-			Weapon->SetSlotIndex(Inventory.Num());
-			Inventory.Add(Weapon);
-			Weapon->SetItemState(EItemState::EIS_PickedUp);
+			Weapon->SetSlotIndex(EmptySlot);
+			Inventory.SetSlot(EmptySlot, MakeInventoryRecord(Weapon));
+
+			// Only the equipped weapon needs an actor; the record is enough until it is equipped
+			if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+			{
+				ItemPool->ReleaseItem(Weapon);
+			}
+			else
+			{
+				Weapon->SetItemState(EItemState::EIS_PickedUp);
+			}
 		}
 		else // Inventory is full! Swap with EquippedWeapon
 		{
@@ -1333,20 +1472,20 @@ void AShooterCharacter::GetPickupItem(AItem* Item)
 	}
 }
 
-FInterpLocation AShooterCharacter::GetInterpLocation(int32 Index)
+FVector AShooterCharacter::GetInterpLocation(int32 Index) const
 {
-	if (Index <= InterpLocations.Num())
+	if (InterpLocations.IsValidIndex(Index))
 	{
-		return InterpLocations[Index];
+		return GetFollowCamera()->GetComponentTransform().TransformPosition(InterpLocations[Index].CameraOffset);
 	}
-	return FInterpLocation();
+	return FVector::ZeroVector;
 }
 
 void AShooterCharacter::IncrementInterpLocItemCount(int32 Index, int32 Amount)
 {
 	if (Amount < -1 || Amount > 1) return;
 
-	if (InterpLocations.Num() >= Index)
+	if (InterpLocations.IsValidIndex(Index))
 	{
 		InterpLocations[Index].ItemCount += Amount;
 	}
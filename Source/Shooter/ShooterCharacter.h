@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AmmoType.h"
+#include "InventoryRecord.h"
 #include "ShooterCharacter.generated.h"
 
 UENUM(BlueprintType)
@@ -24,9 +25,9 @@ struct FInterpLocation
 {
 	GENERATED_BODY()
 
-	// Scene component to use for its location for interping
+	// Offset from the follow camera, in camera space, of this interp location
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-	USceneComponent* SceneComponent;
+	FVector CameraOffset;
 
 	// Number of items interping to/at this scene comp location
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
@@ -131,8 +132,8 @@ protected:
 	/** Drops currently equipped Weapon and Equips TraceHitItem */
 	void SwapWeapon(AWeapon* WeaponToSwap);
 
-	/** Initialize the Ammo Map with ammo values */
-	void InitializeAmmoMap();
+	/** Initialize the carried ammo with the starting ammo values */
+	void InitializeAmmo();
 
 	/** Check to make sure our weapon has ammo */
 	bool WeaponHasAmmo();
@@ -173,6 +174,9 @@ protected:
 
 	void InitializeInterpLocations();
 
+	/** Moves every item in FlightItems toward its interp location */
+	void UpdateItemFlights(float DeltaTime);
+
 	void FKeyPressed();
 	void OneKeyPressed();
 	void TwoKeyPressed();
@@ -182,6 +186,12 @@ protected:
 
 	void ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex);
 
+	/** Record of Weapon's class, type, magazine ammo and rarity */
+	static FInventoryRecord MakeInventoryRecord(const AWeapon* Weapon);
+
+	/** Takes a Weapon for the record in SlotIndex from the item pool */
+	AWeapon* MaterializeInventoryWeapon(int32 SlotIndex);
+
 	int32 GetEmptyInventorySlot();
 
 	void HighlightInventorySlot();
@@ -343,9 +353,13 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 	float CameraInterpElevation;
 
-	/** Map to keep track of ammo of the different ammo types */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
-	TMap<EAmmoType, int32> AmmoMap;
+	/** Sideways spacing between the pickup interp locations in front of the camera */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float InterpLocationColumnSpacing;
+
+	/** Downward spacing between the rows of pickup interp locations */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float InterpLocationRowSpacing;
 
 	/** Starting amount of 9mm ammo */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
@@ -415,30 +429,22 @@ private:
 	/** Used for knowing when the aiming button is pressed */
 	bool bAimingButtonPressed;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* WeaponInterpComp;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp1;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp2;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp3;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp4;
-
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp5;
+	/** Array of interp location structs; index 0 is used by weapons. Built in BeginPlay from the camera interp settings */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
+	TArray<FInterpLocation> InterpLocations;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	USceneComponent* InterpComp6;
+	/** Items flying to an interp location; parallel arrays advanced together in UpdateItemFlights */
+	UPROPERTY()
+	TArray<AItem*> FlightItems;
+	TArray<FVector> FlightStartLocations;
+	TArray<FVector> FlightLocations;
+	TArray<float> FlightElapsedTimes;
+	TArray<float> FlightDurations;
+	TArray<float> FlightYawOffsets;
+	TArray<int32> FlightInterpLocIndices;
 
-	/** Array of interp location structs */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
-	TArray<FInterpLocation> InterpLocations;
+	/** World space interp locations, computed once per frame from the camera transform */
+	TArray<FVector> InterpWorldLocations;
 
 	FTimerHandle PickupSoundTimer;
 	FTimerHandle EquipSoundTimer;
@@ -457,11 +463,8 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
 	float EquipSoundResetTime;
 
-	/** An array of AItems for our Inventory */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
-	TArray<AItem*> Inventory;
-
-	const int32 INVENTORY_CAPACITY{ 6 };
+	/** Weapon records and carried ammo; the EquippedWeapon's record is refreshed when it is unequipped */
+	FInventoryState Inventory;
 
 	/** Delegate for sending slot information to InventoryBar when equipping */
 	UPROPERTY(BlueprintAssignable, Category = Delegates, meta = (AllowPrivateAccess = "true"))
@@ -507,6 +510,10 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bDead;
 
+	/** Limits how many enemies attack this character at once */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UAttackTokenComponent* AttackTokens;
+
 public:
 	/** Returns CameraBoom subobject */
 	FORCEINLINE USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
@@ -523,14 +530,16 @@ public:
 	/** Adds/subtracts to/from OverlappedItemCount and updates bShouldTraceForItems */
 	void IncrementOverlappedItemCount(int8 Amount);
 
-	// No longer needed; AItem has GetInterpLocation
-	//FVector GetCameraInterpLocation();
-
 	void GetPickupItem(AItem* Item);
 
 	FORCEINLINE ECombatState GetCombatState() const { return CombatState; }
 	FORCEINLINE bool GetCrouching() const { return bCrouching; }
-	FInterpLocation GetInterpLocation(int32 Index);
+	FORCEINLINE UAttackTokenComponent* GetAttackTokens() const { return AttackTokens; }
+	/** World location of the interp location at Index, computed from the camera transform */
+	FVector GetInterpLocation(int32 Index) const;
+
+	/** Adds an item to the batched flight toward its interp location */
+	void StartItemFlight(AItem* Item);
 
 	// Returns the index in InterpLocations array with the lowest ItemCount
 	int32 GetInterpLocationIndex();
@@ -545,6 +554,27 @@ public:
 
 	void UnHighlightInventorySlot();
 
+	/** Whole inventory and carried ammo; trivially copyable for snapshots */
+	FORCEINLINE const FInventoryState& GetInventoryState() const { return Inventory; }
+
+	/** Amount of ammo of AmmoType carried outside the magazine */
+	UFUNCTION(BlueprintPure, Category = Items)
+	int32 GetCarriedAmmo(EAmmoType AmmoType) const { return Inventory.GetAmmo(AmmoType); }
+
+	/** Inventory record for SlotIndex, up to date for the EquippedWeapon's slot */
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	FInventoryRecord GetInventoryRecord(int32 SlotIndex) const;
+
+	/** Icons for the inventory bar, looked up from the record's weapon type and rarity */
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	UTexture2D* GetInventoryIcon(int32 SlotIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	UTexture2D* GetInventoryAmmoIcon(int32 SlotIndex) const;
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	UTexture2D* GetInventoryIconBackground(int32 SlotIndex) const;
+
 	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
 	FORCEINLINE USoundCue* GetMeleeImpactSound() const { return MeleeImpactSound; }
 	FORCEINLINE UParticleSystem* GetBloodParticles() const { return BloodParticles; }
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Item.h"
+#include "WeaponType.h"
+
+/** Base values of the stats in FWeaponStatBlock for one DT_Weapon row */
+struct FWeaponTuning
+{
+	int32 MagazineCapacity;
+	float AutoFireRate;
+	float Damage;
+	float HeadShotDamage;
+};
+
+struct FTuningColor
+{
+	float R, G, B, A;
+
+	FORCEINLINE FLinearColor ToLinearColor() const { return FLinearColor(R, G, B, A); }
+};
+
+/** Values of one DT_ItemRarity row */
+struct FRarityTuning
+{
+	FTuningColor GlowColor;
+	FTuningColor LightColor;
+	FTuningColor DarkColor;
+	int32 NumberOfStars;
+	int32 CustomDepthStencil;
+	/** Object path of the icon background texture */
+	const TCHAR* IconBackgroundPath;
+};
+
+/**
+ * Generated/ShooterTuningTables.h is written by UShooterTuningCommandlet and holds
+ * the DT_Weapon and DT_ItemRarity values as constexpr arrays. Shooter.Build.cs sets
+ * SHOOTER_GENERATED_TUNING when the file exists, and warns on non-editor builds without it;
+ * those fall back to the runtime tables. Editor builds keep reading the data tables so
+ * edits show up without regenerating.
+ */
+#ifndef SHOOTER_GENERATED_TUNING
+#define SHOOTER_GENERATED_TUNING 0
+#endif
+
+#if SHOOTER_GENERATED_TUNING
+#include "Generated/ShooterTuningTables.h"
+#endif
+
+#define SHOOTER_USE_GENERATED_TUNING (SHOOTER_GENERATED_TUNING && !WITH_EDITOR)
+
+namespace ShooterTuning
+{
+	/** Generated values for WeaponType, or nullptr when gameplay should read the runtime tables */
+	FORCEINLINE const FWeaponTuning* FindWeapon(EWeaponType WeaponType)
+	{
+#if SHOOTER_USE_GENERATED_TUNING
+		const int32 Index{ (int32)WeaponType };
+		return Index < UE_ARRAY_COUNT(GeneratedWeapons) ? &GeneratedWeapons[Index] : nullptr;
+#else
+		return nullptr;
+#endif
+	}
+
+	/** Generated values for Rarity, or nullptr when gameplay should read the runtime tables */
+	FORCEINLINE const FRarityTuning* FindRarity(EItemRarity Rarity)
+	{
+#if SHOOTER_USE_GENERATED_TUNING
+		const int32 Index{ (int32)Rarity };
+		return Index < UE_ARRAY_COUNT(GeneratedRarities) ? &GeneratedRarities[Index] : nullptr;
+#else
+		return nullptr;
+#endif
+	}
+}
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterTuningCommandlet.h"
+#include "ShooterTuning.h"
+#include "ItemDefinitionSubsystem.h"
+#include "WeaponDefinition.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/AutomationTest.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogShooterTuning, Log, All);
+
+namespace
+{
+	/** Float literal that reads back to exactly Value */
+	FString FormatFloat(float Value)
+	{
+		FString Literal{ FString::Printf(TEXT("%.9g"), Value) };
+		if (!Literal.Contains(TEXT(".")) && !Literal.Contains(TEXT("e")))
+		{
+			Literal += TEXT(".0");
+		}
+		return Literal + TEXT("f");
+	}
+
+	FString FormatColor(const FLinearColor& Color)
+	{
+		return FString::Printf(TEXT("{ %s, %s, %s, %s }"),
+			*FormatFloat(Color.R), *FormatFloat(Color.G), *FormatFloat(Color.B), *FormatFloat(Color.A));
+	}
+
+	FString GetIconBackgroundPath(const FItemRarityTable& Row)
+	{
+		return Row.IconBackground ? FSoftObjectPath(Row.IconBackground).ToString() : FString();
+	}
+
+	FString GetGeneratedHeaderPath()
+	{
+		return FPaths::Combine(FPaths::GameSourceDir(), TEXT("Shooter"), TEXT("Generated"), TEXT("ShooterTuningTables.h"));
+	}
+
+#if SHOOTER_GENERATED_TUNING
+	bool ColorsMatch(const FTuningColor& Generated, const FLinearColor& Source)
+	{
+		return Generated.R == Source.R && Generated.G == Source.G && Generated.B == Source.B && Generated.A == Source.A;
+	}
+#endif
+}
+
+UShooterTuningCommandlet::UShooterTuningCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UShooterTuningCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	ParseCommandLine(*Params, Tokens, Switches);
+
+	if (Switches.Contains(TEXT("verify")))
+	{
+		const int32 NumMismatches{ VerifyGeneratedTables() };
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogShooterTuning, Error, TEXT("%d generated tuning values differ from the source tables; rerun -run=ShooterTuning"), NumMismatches);
+			return 1;
+		}
+		UE_LOG(LogShooterTuning, Display, TEXT("Generated tuning tables match the source tables"));
+		return 0;
+	}
+
+	const FString Header{ GenerateHeader() };
+	if (Header.IsEmpty()) return 1;
+
+	const FString HeaderPath{ GetGeneratedHeaderPath() };
+	FString ExistingHeader;
+	if (FFileHelper::LoadFileToString(ExistingHeader, *HeaderPath) && ExistingHeader == Header)
+	{
+		UE_LOG(LogShooterTuning, Display, TEXT("%s is up to date"), *HeaderPath);
+		return 0;
+	}
+
+	if (!FFileHelper::SaveStringToFile(Header, *HeaderPath))
+	{
+		UE_LOG(LogShooterTuning, Error, TEXT("Could not write %s"), *HeaderPath);
+		return 1;
+	}
+	UE_LOG(LogShooterTuning, Display, TEXT("Wrote %s; regenerate project files so SHOOTER_GENERATED_TUNING is set"), *HeaderPath);
+	return 0;
+#else
+	UE_LOG(LogShooterTuning, Error, TEXT("The tuning tables can only be generated from an editor build"));
+	return 1;
+#endif
+}
+
+FString UShooterTuningCommandlet::GenerateHeader() const
+{
+	const UItemDefinitionSubsystem* ItemDefinitions{ UItemDefinitionSubsystem::Get(nullptr) };
+	const UEnum* WeaponTypeEnum{ StaticEnum<EWeaponType>() };
+	const UEnum* RarityEnum{ StaticEnum<EItemRarity>() };
+
+	FString Header;
+	Header += TEXT("// Generated by UShooterTuningCommandlet from the weapon definitions and DT_ItemRarity.\n");
+	Header += TEXT("// Do not edit; rerun -run=ShooterTuning after changing the tables.\n\n");
+	Header += TEXT("#pragma once\n\n");
+	Header += TEXT("namespace ShooterTuning\n{\n");
+
+	Header += TEXT("\t/** Indexed by EWeaponType */\n");
+	Header += TEXT("\tconstexpr FWeaponTuning GeneratedWeapons[] =\n\t{\n");
+	for (int32 i = 0; i < (int32)EWeaponType::EWT_MAX; i++)
+	{
+		const UWeaponDefinition* Definition{ ItemDefinitions->GetWeaponDefinition((EWeaponType)i) };
+		if (Definition == nullptr)
+		{
+			UE_LOG(LogShooterTuning, Error, TEXT("No weapon definition or DT_Weapon row for %s"), *WeaponTypeEnum->GetNameStringByValue(i));
+			return FString();
+		}
+
+		Header += FString::Printf(TEXT("\t\t{ %d, %s, %s, %s }, // %s\n"),
+			Definition->MagazineCapacity,
+			*FormatFloat(Definition->AutoFireRate),
+			*FormatFloat(Definition->Damage),
+			*FormatFloat(Definition->HeadShotDamage),
+			*WeaponTypeEnum->GetNameStringByValue(i));
+	}
+	Header += TEXT("\t};\n");
+	Header += TEXT("\tstatic_assert(UE_ARRAY_COUNT(GeneratedWeapons) == (int32)EWeaponType::EWT_MAX, \"Regenerate the tuning tables\");\n\n");
+
+	Header += TEXT("\t/** Indexed by EItemRarity */\n");
+	Header += TEXT("\tconstexpr FRarityTuning GeneratedRarities[] =\n\t{\n");
+	for (int32 i = 0; i < (int32)EItemRarity::EIR_MAX; i++)
+	{
+		const FItemRarityTable* RarityRow{ ItemDefinitions->GetRarityRow((EItemRarity)i) };
+		if (RarityRow == nullptr)
+		{
+			UE_LOG(LogShooterTuning, Error, TEXT("No DT_ItemRarity row for %s"), *RarityEnum->GetNameStringByValue(i));
+			return FString();
+		}
+
+		Header += FString::Printf(TEXT("\t\t{ %s, %s, %s, %d, %d, TEXT(\"%s\") }, // %s\n"),
+			*FormatColor(RarityRow->GlowColor),
+			*FormatColor(RarityRow->LightColor),
+			*FormatColor(RarityRow->DarkColor),
+			RarityRow->NumberOfStars,
+			RarityRow->CustomDepthStencil,
+			*GetIconBackgroundPath(*RarityRow),
+			*RarityEnum->GetNameStringByValue(i));
+	}
+	Header += TEXT("\t};\n");
+	Header += TEXT("\tstatic_assert(UE_ARRAY_COUNT(GeneratedRarities) == (int32)EItemRarity::EIR_MAX, \"Regenerate the tuning tables\");\n");
+	Header += TEXT("}\n");
+
+	return Header;
+}
+
+int32 UShooterTuningCommandlet::VerifyGeneratedTables() const
+{
+#if SHOOTER_GENERATED_TUNING
+	const UItemDefinitionSubsystem* ItemDefinitions{ UItemDefinitionSubsystem::Get(nullptr) };
+	int32 NumMismatches{ 0 };
+
+	for (int32 i = 0; i < (int32)EWeaponType::EWT_MAX; i++)
+	{
+		const UWeaponDefinition* Definition{ ItemDefinitions->GetWeaponDefinition((EWeaponType)i) };
+		const FWeaponTuning& Generated{ ShooterTuning::GeneratedWeapons[i] };
+		const bool bMatches{ Definition &&
+			Generated.MagazineCapacity == Definition->MagazineCapacity &&
+			Generated.AutoFireRate == Definition->AutoFireRate &&
+			Generated.Damage == Definition->Damage &&
+			Generated.HeadShotDamage == Definition->HeadShotDamage };
+		if (!bMatches)
+		{
+			UE_LOG(LogShooterTuning, Error, TEXT("Generated weapon tuning for %s is stale"), *StaticEnum<EWeaponType>()->GetNameStringByValue(i));
+			++NumMismatches;
+		}
+	}
+
+	for (int32 i = 0; i < (int32)EItemRarity::EIR_MAX; i++)
+	{
+		const FItemRarityTable* RarityRow{ ItemDefinitions->GetRarityRow((EItemRarity)i) };
+		const FRarityTuning& Generated{ ShooterTuning::GeneratedRarities[i] };
+		const bool bMatches{ RarityRow &&
+			ColorsMatch(Generated.GlowColor, RarityRow->GlowColor) &&
+			ColorsMatch(Generated.LightColor, RarityRow->LightColor) &&
+			ColorsMatch(Generated.DarkColor, RarityRow->DarkColor) &&
+			Generated.NumberOfStars == RarityRow->NumberOfStars &&
+			Generated.CustomDepthStencil == RarityRow->CustomDepthStencil &&
+			GetIconBackgroundPath(*RarityRow) == Generated.IconBackgroundPath };
+		if (!bMatches)
+		{
+			UE_LOG(LogShooterTuning, Error, TEXT("Generated rarity tuning for %s is stale"), *StaticEnum<EItemRarity>()->GetNameStringByValue(i));
+			++NumMismatches;
+		}
+	}
+
+	// The header on disk may be newer than the compiled tables
+	FString ExistingHeader;
+	if (!FFileHelper::LoadFileToString(ExistingHeader, *GetGeneratedHeaderPath()) || ExistingHeader != GenerateHeader())
+	{
+		UE_LOG(LogShooterTuning, Error, TEXT("%s is missing or out of date"), *GetGeneratedHeaderPath());
+		++NumMismatches;
+	}
+
+	return NumMismatches;
+#else
+	UE_LOG(LogShooterTuning, Error, TEXT("No generated tuning tables are compiled in; run -run=ShooterTuning and rebuild"));
+	return 1;
+#endif
+}
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShooterTuningTablesTest, "Shooter.Tuning.GeneratedTablesMatch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FShooterTuningTablesTest::RunTest(const FString& Parameters)
+{
+	// Every stale value is also logged as an error by the verify pass, which counts missing tables as one mismatch
+	return TestEqual(TEXT("Stale or missing generated tuning values"), GetDefault<UShooterTuningCommandlet>()->VerifyGeneratedTables(), 0);
+}
+
+#endif
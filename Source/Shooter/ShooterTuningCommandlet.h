@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterTuningCommandlet.generated.h"
+
+/**
+ * Writes Generated/ShooterTuningTables.h from the weapon definitions (DT_Weapon rows
+ * for types without a definition asset) and DT_ItemRarity.
+ *
+ * UE4Editor-Cmd Shooter.uproject -run=ShooterTuning            Regenerates the header
+ * UE4Editor-Cmd Shooter.uproject -run=ShooterTuning -verify    Fails if the compiled-in tables
+ *                                                               differ from the source tables
+ *
+ * The Shooter.Tuning.GeneratedTablesMatch automation test runs the same comparison.
+ */
+UCLASS()
+class SHOOTER_API UShooterTuningCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UShooterTuningCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** Compares the compiled-in generated tables with the source tables; returns the number of mismatches */
+	int32 VerifyGeneratedTables() const;
+
+private:
+	/** Contents of the generated header for the current source tables */
+	FString GenerateHeader() const;
+};
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform hash grid for radius queries over many points that move every frame.
+ * Rebuilt from scratch each pass: Reset keeps the allocations, Add is O(1),
+ * and ForEachInRadius only visits the cells overlapping the query sphere.
+ * Elements of a cell are kept as a linked list through flat arrays so
+ * rebuilding does not allocate per cell.
+ */
+template<typename ElementType>
+class TSpatialHashGrid
+{
+public:
+	explicit TSpatialHashGrid(float InCellSize = 500.f)
+	{
+		SetCellSize(InCellSize);
+	}
+
+	/** Cell size should be close to the most common query radius */
+	void SetCellSize(float InCellSize)
+	{
+		CellSize = FMath::Max(InCellSize, 1.f);
+		InvCellSize = 1.f / CellSize;
+	}
+
+	FORCEINLINE float GetCellSize() const { return CellSize; }
+	FORCEINLINE int32 Num() const { return Elements.Num(); }
+
+	/** Removes all elements; keeps the allocations for the next rebuild */
+	void Reset()
+	{
+		CellHeads.Reset();
+		Elements.Reset();
+		Locations.Reset();
+		NextInCell.Reset();
+	}
+
+	void Reserve(int32 Number)
+	{
+		CellHeads.Reserve(Number);
+		Elements.Reserve(Number);
+		Locations.Reserve(Number);
+		NextInCell.Reserve(Number);
+	}
+
+	/** Adds Element at Location. Returns its index, valid until the next Reset */
+	int32 Add(const FVector& Location, const ElementType& Element)
+	{
+		const int32 Index{ Elements.Add(Element) };
+		Locations.Add(Location);
+
+		int32& Head{ CellHeads.FindOrAdd(GetCell(Location), INDEX_NONE) };
+		NextInCell.Add(Head);
+		Head = Index;
+		return Index;
+	}
+
+	FORCEINLINE const ElementType& GetElement(int32 Index) const { return Elements[Index]; }
+	FORCEINLINE const FVector& GetLocation(int32 Index) const { return Locations[Index]; }
+
+	/**
+	* Calls Func(Index, Element, DistSquared) for every element within Radius of Location.
+	* Elements are visited cell by cell, not sorted by distance.
+	*/
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Location, float Radius, FuncType&& Func) const
+	{
+		const float RadiusSquared{ Radius * Radius };
+		const FIntVector MinCell{ GetCell(Location - FVector(Radius)) };
+		const FIntVector MaxCell{ GetCell(Location + FVector(Radius)) };
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					const int32* Head{ CellHeads.Find(FIntVector(X, Y, Z)) };
+					for (int32 Index = Head ? *Head : INDEX_NONE; Index != INDEX_NONE; Index = NextInCell[Index])
+					{
+						const float DistSquared{ FVector::DistSquared(Locations[Index], Location) };
+						if (DistSquared <= RadiusSquared)
+						{
+							Func(Index, Elements[Index], DistSquared);
+						}
+					}
+				}
+			}
+		}
+	}
+
+private:
+	FORCEINLINE FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(Location.X * InvCellSize),
+			FMath::FloorToInt(Location.Y * InvCellSize),
+			FMath::FloorToInt(Location.Z * InvCellSize));
+	}
+
+	float CellSize;
+	float InvCellSize;
+
+	/** First element index of each occupied cell */
+	TMap<FIntVector, int32> CellHeads;
+
+	TArray<ElementType> Elements;
+	TArray<FVector> Locations;
+	/** Next element index in the same cell, or INDEX_NONE */
+	TArray<int32> NextInCell;
+};
@@ -1,32 +1,113 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Weapon.h"
+#include "ItemDefinitionSubsystem.h"
+#include "WeaponDefinition.h"
+#include "Engine/Texture2D.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundCue.h"
+#include "Engine/CollisionProfile.h"
+#include "Serialization/ArchiveCountMem.h"
+
+static FAutoConsoleCommandWithWorldAndArgs WeaponMemoryCommand(
+	TEXT("Shooter.Weapons.MeasureMemory"),
+	TEXT("Spawns Weapons and logs their memory with shared definitions against a copy of the definition in every Weapon. Args: weapon count (default 500)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) return;
+
+		const int32 WeaponCount{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500 };
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		// Same counter as obj list: the weapon and its components count per instance, definitions once.
+		// CopiedDefinitionBytes is what the definitions would cost if every Weapon carried its own copy
+		SIZE_T InstanceBytes{ 0 };
+		SIZE_T DefinitionBytes{ 0 };
+		SIZE_T CopiedDefinitionBytes{ 0 };
+		TMap<const UWeaponDefinition*, SIZE_T> Definitions;
+		TArray<AWeapon*> Weapons;
+		for (int32 Index = 0; Index < WeaponCount; ++Index)
+		{
+			AWeapon* Weapon{ World->SpawnActor<AWeapon>(AWeapon::StaticClass(), FTransform::Identity, SpawnParameters) };
+			if (Weapon == nullptr) continue;
+
+			Weapon->SetWeaponType(static_cast<EWeaponType>(Index % static_cast<int32>(EWeaponType::EWT_MAX)));
+			Weapons.Add(Weapon);
+
+			InstanceBytes += FArchiveCountMem(Weapon).GetMax();
+			for (const UActorComponent* Component : Weapon->GetComponents())
+			{
+				InstanceBytes += FArchiveCountMem(Component).GetMax();
+			}
+
+			const UWeaponDefinition* Definition{ Weapon->GetWeaponDefinition() };
+			if (Definition == nullptr) continue;
+
+			const SIZE_T* KnownBytes{ Definitions.Find(Definition) };
+			const SIZE_T Bytes{ KnownBytes ? *KnownBytes : Definitions.Add(Definition, FArchiveCountMem(Definition).GetMax()) };
+			if (KnownBytes == nullptr)
+			{
+				DefinitionBytes += Bytes;
+			}
+			CopiedDefinitionBytes += Bytes;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("%d Weapons: %.1f KB per instance (%.1f KB total), %d shared definitions %.1f KB; shared %.1f KB against %.1f KB with a copy per Weapon"),
+			Weapons.Num(),
+			Weapons.Num() > 0 ? InstanceBytes / 1024.0 / Weapons.Num() : 0.0,
+			InstanceBytes / 1024.0,
+			Definitions.Num(),
+			DefinitionBytes / 1024.0,
+			(InstanceBytes + DefinitionBytes) / 1024.0,
+			(InstanceBytes + CopiedDefinitionBytes) / 1024.0);
+
+		for (AWeapon* Weapon : Weapons)
+		{
+			Weapon->Destroy();
+		}
+	}));
 
 AWeapon::AWeapon() :
 	ThrowWeaponTime(0.7f),
 	bFalling(false),
+	bFollowingDropArc(false),
+	bAnalyticDrop(true),
+	DropSpeed(400.f),
+	DropMaxFlightTime(1.5f),
+	DropSweepSegments(4),
+	DropSweepRadius(10.f),
+	DropGravityZ(-980.f),
+	DropImpactTime(0.f),
+	DropLandingTime(0.f),
+	DropElapsedTime(0.f),
 	Ammo(30),
-	MagazineCapacity(30),
 	WeaponType(EWeaponType::EWT_SubmachineGun),
-	AmmoType(EAmmoType::EAT_9mm),
-	ReloadMontageSection(FName(TEXT("Reload SMG"))),
-	ClipBoneName(TEXT("smg_clip")),
 	SlideDisplacement(0.f),
 	SlideDisplacementTime(0.2f),
 	bMovingSlide(false),
 	MaxSlideDisplacement(4.f),
 	MaxRecoilRotation(20.f),
-	bAutomatic(true)
+	WeaponDefinition(GetDefault<UWeaponDefinition>()),
+	bWeaponPropertiesApplied(false),
+	bHoldsWeaponAssets(false),
+	HeldAssetsType(EWeaponType::EWT_SubmachineGun),
+	Behavior(&FWeaponBehavior::Get(EWeaponType::EWT_SubmachineGun))
 {
-
+	Stats = FWeaponStatBlock::Build(*WeaponDefinition, Modifiers);
 }
 
 void AWeapon::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (GetItemState() == EItemState::EIS_Falling && bFalling && bFollowingDropArc)
+	{
+		UpdateDropArc(DeltaTime);
+	}
 	// Keep the Weapon upright
-	if (GetItemState() == EItemState::EIS_Falling && bFalling)
+	else if (GetItemState() == EItemState::EIS_Falling && bFalling)
 	{
 		const FRotator MeshRotation{ 0.f, GetItemMesh()->GetComponentRotation().Yaw, 0.f };
 		GetItemMesh()->SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
@@ -47,19 +128,136 @@ void AWeapon::ThrowWeapon()
 
 	float RandomRotation{ FMath::FRandRange(0, 30.f) };
 	ImpulseDirection = ImpulseDirection.RotateAngleAxis(RandomRotation, FVector(0.f, 0.f, 1.f));
-	ImpulseDirection *= 20'000.f;
-	GetItemMesh()->AddImpulse(ImpulseDirection);
 
 	bFalling = true;
-	GetWorldTimerManager().SetTimer(
-		ThrowWeaponTimer, 
-		this, 
-		&AWeapon::StopFalling, 
-		ThrowWeaponTime);
+	// Sweep the arc once up front; Tick moves the Weapon along it
+	bFollowingDropArc = bAnalyticDrop && ComputeDropArc(GetActorLocation(), ImpulseDirection * DropSpeed);
+	if (!bFollowingDropArc)
+	{
+		if (bAnalyticDrop)
+		{
+			// No floor under the arc; let physics bring the Weapon to rest instead
+			Super::ApplyStateCollision(GetStateCollision(EItemState::EIS_Falling));
+		}
+
+		ImpulseDirection *= 20'000.f;
+		GetItemMesh()->AddImpulse(ImpulseDirection);
+
+		GetWorldTimerManager().SetTimer(
+			ThrowWeaponTimer,
+			this,
+			&AWeapon::StopFalling,
+			ThrowWeaponTime);
+	}
 
 	EnableGlowMaterial();
 }
 
+bool AWeapon::ComputeDropArc(const FVector& StartLocation, const FVector& LaunchVelocity)
+{
+	DropStartLocation = StartLocation;
+	DropVelocity = LaunchVelocity;
+	DropGravityZ = GetWorld()->GetGravityZ();
+	DropElapsedTime = 0.f;
+
+	auto ArcLocation = [this](float Time)
+	{
+		return DropStartLocation + DropVelocity * Time + FVector(0.f, 0.f, 0.5f * DropGravityZ * Time * Time);
+	};
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponDropArc), false, this);
+	QueryParams.AddIgnoredActor(GetOwner());
+	const FCollisionObjectQueryParams ObjectParams(ECollisionChannel::ECC_WorldStatic);
+	const FCollisionShape SweepShape{ FCollisionShape::MakeSphere(DropSweepRadius) };
+
+	// Default to the end of the arc if nothing is hit
+	DropImpactTime = DropMaxFlightTime;
+	DropImpactLocation = ArcLocation(DropMaxFlightTime);
+	bool bHitFloor{ false };
+
+	const int32 NumSegments{ FMath::Max(DropSweepSegments, 1) };
+	const float SegmentTime{ DropMaxFlightTime / NumSegments };
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const float SegmentStartTime{ Segment * SegmentTime };
+		FHitResult Hit;
+		if (GetWorld()->SweepSingleByObjectType(
+			Hit,
+			ArcLocation(SegmentStartTime),
+			ArcLocation(SegmentStartTime + SegmentTime),
+			FQuat::Identity,
+			ObjectParams,
+			SweepShape,
+			QueryParams))
+		{
+			// Already overlapping at the segment start, e.g. the thrower's hand inside a wall
+			if (Hit.bStartPenetrating) continue;
+
+			DropImpactTime = SegmentStartTime + Hit.Time * SegmentTime;
+			DropImpactLocation = Hit.Location;
+			bHitFloor = Hit.ImpactNormal.Z > 0.7f;
+			if (!bHitFloor)
+			{
+				// Move off the wall so the drop below does not start touching it
+				DropImpactLocation += Hit.ImpactNormal * (DropSweepRadius + 1.f);
+			}
+			break;
+		}
+	}
+
+	DropLandingLocation = DropImpactLocation;
+	DropLandingTime = DropImpactTime;
+	if (!bHitFloor)
+	{
+		// Hit a wall or nothing: drop straight down from the impact point
+		FHitResult FloorHit;
+		const bool bFoundFloor{ GetWorld()->SweepSingleByObjectType(
+			FloorHit,
+			DropImpactLocation,
+			DropImpactLocation - FVector(0.f, 0.f, 10'000.f),
+			FQuat::Identity,
+			ObjectParams,
+			SweepShape,
+			QueryParams) };
+		if (!bFoundFloor || FloorHit.bStartPenetrating) return false;
+
+		DropLandingLocation = FloorHit.Location;
+		const float FallHeight{ DropImpactLocation.Z - DropLandingLocation.Z };
+		DropLandingTime += FMath::Sqrt(2.f * FallHeight / FMath::Max(-DropGravityZ, KINDA_SMALL_NUMBER));
+	}
+	// Rest the Weapon on the surface instead of at the sweep sphere's center
+	DropLandingLocation.Z -= DropSweepRadius;
+	return true;
+}
+
+void AWeapon::UpdateDropArc(float DeltaTime)
+{
+	DropElapsedTime += DeltaTime;
+
+	FVector Location;
+	if (DropElapsedTime >= DropLandingTime)
+	{
+		Location = DropLandingLocation;
+	}
+	else if (DropElapsedTime < DropImpactTime)
+	{
+		Location = DropStartLocation + DropVelocity * DropElapsedTime + FVector(0.f, 0.f, 0.5f * DropGravityZ * DropElapsedTime * DropElapsedTime);
+	}
+	else
+	{
+		// Falling straight down after hitting a wall
+		const float FallTime{ DropElapsedTime - DropImpactTime };
+		Location = DropImpactLocation;
+		Location.Z = FMath::Max(DropImpactLocation.Z + 0.5f * DropGravityZ * FallTime * FallTime, DropLandingLocation.Z);
+	}
+	SetActorLocation(Location);
+
+	if (DropElapsedTime >= DropLandingTime)
+	{
+		StopFalling();
+	}
+}
+
 void AWeapon::StopFalling()
 {
 	bFalling = false;
@@ -71,78 +269,168 @@ void AWeapon::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
 
-	// Load the data in the Weapon Data Table
-	const FString WeaponTablePath{ TEXT("DataTable'/Game/_Game/DataTable/DT_Weapon.DT_Weapon'") };
-	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
+	ApplyWeaponProperties();
+}
+
+void AWeapon::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
 
-	if (WeaponTableObject)
+	// Placed and PIE-duplicated Weapons skip OnConstruction, and Stats and Behavior are not serialized
+	if (!bWeaponPropertiesApplied)
 	{
-		FWeaponDataTable* WeaponDataRow = nullptr;
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_SubmachineGun:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("SubmachineGun"), TEXT(""));
-			break;
-		case EWeaponType::EWT_AssaultRifle:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
-		case EWeaponType::EWT_Pistol:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Pistol"), TEXT(""));
-			break;
-		}
+		ApplyWeaponProperties();
+	}
+}
+
+void AWeapon::ApplyWeaponProperties()
+{
+	Behavior = &FWeaponBehavior::Get(WeaponType);
+
+	// Get the Weapon definition from the cached item definitions
+	UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this);
+	const UWeaponDefinition* Definition = ItemDefinitions ? ItemDefinitions->GetWeaponDefinition(WeaponType) : nullptr;
+	if (Definition == nullptr) return;
 
-		if (WeaponDataRow)
+	// Stats are read from the shared definition; only per-instance state is copied
+	WeaponDefinition = Definition;
+	bWeaponPropertiesApplied = true;
+	Ammo = Definition->WeaponAmmo;
+	SetItemName(Definition->ItemName);
+	RebuildStats();
+
+	// Meshes, sounds and textures may still need streaming
+	const UWorld* World = GetWorld();
+	if (World == nullptr || !World->IsGameWorld())
+	{
+		if (!Definition->AreAssetsLoaded())
 		{
-			AmmoType = WeaponDataRow->AmmoType;
-			Ammo = WeaponDataRow->WeaponAmmo;
-			MagazineCapacity = WeaponDataRow->MagazingCapacity;
-			SetPickupSound(WeaponDataRow->PickupSound);
-			SetEquipSound(WeaponDataRow->EquipSound);
-			GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh);
-			SetItemName(WeaponDataRow->ItemName);
-			SetIconItem(WeaponDataRow->InventoryIcon);
-			SetAmmoIcon(WeaponDataRow->AmmoIcon);
-
-			SetMaterialInstance(WeaponDataRow->MaterialInstance);
-			PreviousMaterialIndex = GetMaterialIndex();
-			GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
-			SetMaterialIndex(WeaponDataRow->MaterialIndex);
-			SetClipBoneName(WeaponDataRow->ClipBoneName);
-			SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
-			GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP);
-			CrosshairsMiddle = WeaponDataRow->CrosshairsMiddle;
-			CrosshairsLeft = WeaponDataRow->CrosshairsLeft;
-			CrosshairsRight = WeaponDataRow->CrosshairsRight;
-			CrosshairsTop = WeaponDataRow->CrosshairsTop;
-			CrosshairsBottom = WeaponDataRow->CrosshairsBottom;
-			AutoFireRate = WeaponDataRow->AutoFireRate;
-			MuzzleFlash = WeaponDataRow->MuzzleFlash;
-			FireSound = WeaponDataRow->FireSound;
-			BoneToHide = WeaponDataRow->BoneToHide;
-			bAutomatic = WeaponDataRow->bAutomatic;
-			Damage = WeaponDataRow->Damage;
-			HeadShotDamage = WeaponDataRow->HeadShotDamage;
+			Definition->LoadAssetsSynchronous();
 		}
-
-		if (GetMaterialInstance())
+		ApplyWeaponAssets();
+	}
+	else if (bHoldsWeaponAssets && HeldAssetsType == WeaponType)
+	{
+		// Already requested; a pending load applies them when it finishes
+		ApplyWeaponAssets();
+	}
+	else
+	{
+		// Keeps the type's bundles loaded until this Weapon changes type or ends play
+		ReleaseWeaponAssets();
+		bHoldsWeaponAssets = true;
+		HeldAssetsType = WeaponType;
+		ItemDefinitions->RequestWeaponAssets(WeaponType, FStreamableDelegate::CreateWeakLambda(this, [this]()
 		{
-			SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
-			GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("FresnelColor"), GetGlowColor());
-			GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
+			ApplyWeaponAssets();
+		}));
+	}
+}
 
-			EnableGlowMaterial();
-		}
+void AWeapon::ReleaseWeaponAssets()
+{
+	if (!bHoldsWeaponAssets) return;
+	bHoldsWeaponAssets = false;
+
+	if (UItemDefinitionSubsystem* ItemDefinitions = UItemDefinitionSubsystem::Get(this))
+	{
+		ItemDefinitions->ReleaseWeaponAssets(HeldAssetsType);
+	}
+}
+
+void AWeapon::ApplyWeaponAssets()
+{
+	const UWeaponDefinition* Definition = WeaponDefinition;
+	if (!Definition->AreAssetsLoaded()) return;
+
+	SetPickupSound(Definition->PickupSound.Get());
+	SetEquipSound(Definition->EquipSound.Get());
+	GetItemMesh()->SetSkeletalMesh(Definition->ItemMesh.Get());
+	SetIconItem(Definition->InventoryIcon.Get());
+	SetAmmoIcon(Definition->AmmoIcon.Get());
+
+	SetMaterialInstance(Definition->MaterialInstance.Get());
+	PreviousMaterialIndex = GetMaterialIndex();
+	GetItemMesh()->SetMaterial(PreviousMaterialIndex, nullptr);
+	SetMaterialIndex(Definition->MaterialIndex);
+	GetItemMesh()->SetAnimInstanceClass(Definition->AnimBP.Get());
+
+	if (GetMaterialInstance())
+	{
+		SetDynamicMaterialInstance(UMaterialInstanceDynamic::Create(GetMaterialInstance(), this));
+		GetDynamicMaterialInstance()->SetVectorParameterValue(TEXT("FresnelColor"), GetGlowColor());
+		GetItemMesh()->SetMaterial(GetMaterialIndex(), GetDynamicMaterialInstance());
+
+		EnableGlowMaterial();
+	}
+
+	// A new mesh shows every bone again
+	if (WeaponDefinition->BoneToHide != FName(""))
+	{
+		GetItemMesh()->HideBoneByName(WeaponDefinition->BoneToHide, EPhysBodyOp::PBO_None);
+	}
+}
+
+void AWeapon::SetWeaponType(EWeaponType Type)
+{
+	if (WeaponType == Type) return;
 
+	// SetSkeletalMesh keeps hidden bones when the new type shares the mesh; ApplyWeaponAssets hides the new type's bone
+	if (WeaponDefinition && WeaponDefinition->BoneToHide != FName(""))
+	{
+		GetItemMesh()->UnHideBoneByName(WeaponDefinition->BoneToHide);
 	}
+
+	WeaponType = Type;
+	ApplyWeaponProperties();
 }
 
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
-	if (BoneToHide != FName(""))
+	if (WeaponDefinition && WeaponDefinition->BoneToHide != FName(""))
+	{
+		GetItemMesh()->HideBoneByName(WeaponDefinition->BoneToHide, EPhysBodyOp::PBO_None);
+	}
+}
+
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseWeaponAssets();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AWeapon::ResetItem()
+{
+	Super::ResetItem();
+
+	bFalling = false;
+	bFollowingDropArc = false;
+	bMovingSlide = false;
+	bMovingClip = false;
+	SlideDisplacement = 0.f;
+	RecoilRotation = 0.f;
+	DropElapsedTime = 0.f;
+
+	// A pooled Weapon comes back without attachments
+	Modifiers.Reset();
+	RebuildStats();
+	Ammo = WeaponDefinition->WeaponAmmo;
+}
+
+void AWeapon::ApplyStateCollision(const FItemStateCollision& StateCollision)
+{
+	if (bAnalyticDrop && StateCollision.bSimulatePhysics)
 	{
-		GetItemMesh()->HideBoneByName(BoneToHide, EPhysBodyOp::PBO_None);
+		// The drop arc is swept up front, so the mesh needs no physics body while falling
+		FItemStateCollision KinematicCollision{ StateCollision };
+		KinematicCollision.MeshProfile = UCollisionProfile::NoCollision_ProfileName;
+		KinematicCollision.bSimulatePhysics = false;
+		Super::ApplyStateCollision(KinematicCollision);
+		return;
 	}
+	Super::ApplyStateCollision(StateCollision);
 }
 
 void AWeapon::FinishMovingSlide()
@@ -186,11 +474,91 @@ void AWeapon::StartSlideTimer()
 
 void AWeapon::ReloadAmmo(int32 Amount)
 {
-	checkf(Ammo + Amount <= MagazineCapacity, TEXT("Attempted to reload with more than magazine capacity!"));
+	checkf(Ammo + Amount <= GetMagazineCapacity(), TEXT("Attempted to reload with more than magazine capacity!"));
 	Ammo += Amount;
 }
 
 bool AWeapon::ClipIsFull()
 {
-	return Ammo >= MagazineCapacity;
+	return Ammo >= GetMagazineCapacity();
+}
+
+void AWeapon::RebuildStats()
+{
+	Stats = FWeaponStatBlock::Build(*WeaponDefinition, Modifiers);
+	Ammo = FMath::Min(Ammo, GetMagazineCapacity());
+}
+
+bool AWeapon::AddModifier(const FWeaponModifier& Modifier)
+{
+	// Inventory records keep a fixed number of modifier names
+	if (Modifiers.Num() >= MaxWeaponModifiers) return false;
+
+	Modifiers.Add(Modifier);
+	RebuildStats();
+	return true;
+}
+
+bool AWeapon::RemoveModifier(FName ModifierName)
+{
+	const int32 NumRemoved{ Modifiers.RemoveAll([ModifierName](const FWeaponModifier& Modifier)
+	{
+		return Modifier.ModifierName == ModifierName;
+	}) };
+
+	if (NumRemoved == 0) return false;
+
+	RebuildStats();
+	return true;
+}
+
+void AWeapon::SetModifiers(TArray<FWeaponModifier>&& NewModifiers)
+{
+	check(NewModifiers.Num() <= MaxWeaponModifiers);
+
+	Modifiers = MoveTemp(NewModifiers);
+	RebuildStats();
+}
+
+void AWeapon::ClearModifiers()
+{
+	if (Modifiers.Num() == 0) return;
+
+	Modifiers.Reset();
+	RebuildStats();
+}
+
+UParticleSystem* AWeapon::GetMuzzleFlash() const
+{
+	return WeaponDefinition->MuzzleFlash.Get();
+}
+
+USoundCue* AWeapon::GetFireSound() const
+{
+	return WeaponDefinition->FireSound.Get();
+}
+
+UTexture2D* AWeapon::GetCrosshairsMiddle() const
+{
+	return WeaponDefinition->CrosshairsMiddle.Get();
+}
+
+UTexture2D* AWeapon::GetCrosshairsLeft() const
+{
+	return WeaponDefinition->CrosshairsLeft.Get();
+}
+
+UTexture2D* AWeapon::GetCrosshairsRight() const
+{
+	return WeaponDefinition->CrosshairsRight.Get();
+}
+
+UTexture2D* AWeapon::GetCrosshairsBottom() const
+{
+	return WeaponDefinition->CrosshairsBottom.Get();
+}
+
+UTexture2D* AWeapon::GetCrosshairsTop() const
+{
+	return WeaponDefinition->CrosshairsTop.Get();
 }
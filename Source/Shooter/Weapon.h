@@ -7,6 +7,9 @@
 #include "AmmoType.h"
 #include "Engine/DataTable.h"
 #include "WeaponType.h"
+#include "WeaponDefinition.h"
+#include "WeaponModifier.h"
+#include "WeaponBehavior.h"
 #include "Weapon.generated.h"
 
 USTRUCT(BlueprintType)
@@ -109,81 +112,114 @@ protected:
 
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	/** Resolves the definition for Weapons that were loaded or duplicated rather than constructed */
+	virtual void PostInitializeComponents() override;
+
+	/** Sets stats from the Weapon definition for WeaponType, and its assets once they are streamed in */
+	void ApplyWeaponProperties();
+
+	/** Sets mesh, materials, sounds and textures from the Weapon definition; does nothing until they are loaded */
+	void ApplyWeaponAssets();
+
+	/** Lets go of the asset bundles this Weapon keeps loaded, if any */
+	void ReleaseWeaponAssets();
+
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Also restores the falling, slide and clip state and refills the magazine */
+	virtual void ResetItem() override;
+
+	/** Drops the physics body from the falling state when bAnalyticDrop is set */
+	virtual void ApplyStateCollision(const FItemStateCollision& StateCollision) override;
+
+	/** Sweeps the drop arc in DropSweepSegments segments and stores the impact and landing points. False when no floor is found */
+	bool ComputeDropArc(const FVector& StartLocation, const FVector& LaunchVelocity);
+
+	/** Moves the Weapon along the drop arc; calls StopFalling once it has landed */
+	void UpdateDropArc(float DeltaTime);
+
 	void FinishMovingSlide();
 	void UpdateSlideDisplacement();
 
+	/** Aggregates Modifiers over the definition into Stats; clamps Ammo to the new magazine capacity */
+	void RebuildStats();
+
 private:
 	FTimerHandle ThrowWeaponTimer;
 	float ThrowWeaponTime;
 	bool bFalling;
 
+	/** True while the Weapon follows the drop arc; false when it fell back to physics */
+	bool bFollowingDropArc;
+
+	/** When true, a dropped Weapon follows a precomputed ballistic arc instead of simulating physics */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties|Drop", meta = (AllowPrivateAccess = "true"))
+	bool bAnalyticDrop;
+
+	/** Launch speed of the drop arc */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties|Drop", meta = (AllowPrivateAccess = "true"))
+	float DropSpeed;
+
+	/** Longest time the drop arc is swept for before the Weapon is left where it is */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties|Drop", meta = (AllowPrivateAccess = "true"))
+	float DropMaxFlightTime;
+
+	/** Number of straight segments used to sweep the drop arc */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties|Drop", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "16"))
+	int32 DropSweepSegments;
+
+	/** Radius of the sphere swept along the drop arc */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon Properties|Drop", meta = (AllowPrivateAccess = "true"))
+	float DropSweepRadius;
+
+	/** Drop arc, computed once in ThrowWeapon */
+	FVector DropStartLocation;
+	FVector DropVelocity;
+	float DropGravityZ;
+	/** Where and when the arc first hits the world */
+	FVector DropImpactLocation;
+	float DropImpactTime;
+	/** Where and when the Weapon comes to rest; below DropImpactLocation when the arc hits a wall */
+	FVector DropLandingLocation;
+	float DropLandingTime;
+	float DropElapsedTime;
+
 	/** Ammo count for this Weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	int32 Ammo;
 
-	/** Maximum ammo that our weapon can hold */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	int32 MagazineCapacity;
-
 	/** The type of weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	EWeaponType WeaponType;
 
-	/** The type of ammo for this weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	EAmmoType AmmoType;
-
-	/** FName for the Reload Montage Section */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	FName ReloadMontageSection;
-
 	/** True when moving the clip while reloading */	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
 	bool bMovingClip;
 
-	/** Name for the clip bone */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	FName ClipBoneName;
-
-	/** Data table for weapon properties */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UDataTable* WeaponDataTable;
-
 	int32 PreviousMaterialIndex;
 
-	/** Textures for the weapon crosshairs */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsMiddle;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsLeft;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsRight;
+	/** Shared, immutable definition for WeaponType. Transient like the fallback rows; ApplyWeaponProperties resolves it on every instance */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	const UWeaponDefinition* WeaponDefinition;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsBottom;
+	/** Set once ApplyWeaponProperties has resolved WeaponDefinition, Behavior and Stats on this instance */
+	bool bWeaponPropertiesApplied;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UTexture2D* CrosshairsTop;
+	/** True while this Weapon keeps the asset bundles of HeldAssetsType loaded */
+	bool bHoldsWeaponAssets;
+	EWeaponType HeldAssetsType;
 
-	/** The speed at which automatic fire happens */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	float AutoFireRate;
+	/** Attachments and perks applied on top of the definition */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	TArray<FWeaponModifier> Modifiers;
 
-	/** Particle system spawned at the BarrelSocket */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* MuzzleFlash;
+	/** Stats after Modifiers; rebuilt only when they or the definition change */
+	FWeaponStatBlock Stats;
 
-	/** Sound played when the weapon is fired */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	USoundCue* FireSound;
-
-	/** Name of the bone to hide on the weapon mesh */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = DataTable, meta = (AllowPrivateAccess = "true"))
-	FName BoneToHide;
+	/** Fire, reload and cycling behaviour for WeaponType; never null */
+	const FWeaponBehavior* Behavior;
 
 	/** Amount that the slide is pushed back during pistol fire */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
@@ -216,40 +252,64 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pistol, meta = (AllowPrivateAccess = "true"))
 	float RecoilRotation;
 
-	/** True for auto gunfire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	bool bAutomatic;
-
-	/** Amount of damage caused by a bullet */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	float Damage;
-
-	/** Amount of damage when a bullet hits the head */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
-	float HeadShotDamage;
-
 public:
 	/** Adds an impulse to the Weapon */
 	void ThrowWeapon();
 
 	FORCEINLINE int32 GetAmmo() const { return Ammo; }
-	FORCEINLINE int32 GetMagazineCapacity() const { return MagazineCapacity; }
+	FORCEINLINE int32 GetMagazineCapacity() const { return (int32)Stats.Get(EWeaponStat::EWS_MagazineCapacity); }
 
 	/** Called from Character class when firing Weapon */
 	void DecrementAmmo();
 
 	FORCEINLINE EWeaponType GetWeaponType() const { return WeaponType; }
-	FORCEINLINE EAmmoType GetAmmoType() const { return AmmoType; }
-	FORCEINLINE FName GetReloadMontageSection() const { return ReloadMontageSection; }
-	FORCEINLINE void SetReloadMontageSection(FName Name) { ReloadMontageSection = Name; }
-	FORCEINLINE FName GetClipBoneName() const { return ClipBoneName; }
-	FORCEINLINE void SetClipBoneName(FName Name) { ClipBoneName = Name; }
-	FORCEINLINE float GetAutoFireRate() const { return AutoFireRate; }
-	FORCEINLINE UParticleSystem* GetMuzzleFlash() const { return MuzzleFlash; }
-	FORCEINLINE USoundCue* GetFireSound() const { return FireSound; }
-	FORCEINLINE bool GetAutomatic() const { return bAutomatic; }
-	FORCEINLINE float GetDamage() const { return Damage; }
-	FORCEINLINE float GetHeadShotDamage() const { return HeadShotDamage; }
+
+	/** Changes the weapon type after construction; used when a pooled Weapon is materialized from an inventory record */
+	void SetWeaponType(EWeaponType Type);
+	FORCEINLINE void SetAmmo(int32 Amount) { Ammo = Amount; }
+	FORCEINLINE const UWeaponDefinition* GetWeaponDefinition() const { return WeaponDefinition; }
+	FORCEINLINE const FWeaponBehavior& GetBehavior() const { return *Behavior; }
+	FORCEINLINE EAmmoType GetAmmoType() const { return WeaponDefinition->AmmoType; }
+	FORCEINLINE FName GetReloadMontageSection() const { return WeaponDefinition->ReloadMontageSection; }
+	FORCEINLINE FName GetClipBoneName() const { return WeaponDefinition->ClipBoneName; }
+	FORCEINLINE float GetAutoFireRate() const { return Stats.Get(EWeaponStat::EWS_AutoFireRate); }
+	UParticleSystem* GetMuzzleFlash() const;
+	USoundCue* GetFireSound() const;
+	FORCEINLINE bool GetAutomatic() const { return WeaponDefinition->bAutomatic; }
+	FORCEINLINE float GetDamage() const { return Stats.Get(EWeaponStat::EWS_Damage); }
+	FORCEINLINE float GetHeadShotDamage() const { return Stats.Get(EWeaponStat::EWS_HeadShotDamage); }
+
+	/** Adds an attachment or perk and rebuilds Stats; returns false once MaxWeaponModifiers are held */
+	UFUNCTION(BlueprintCallable, Category = "Weapon Properties")
+	bool AddModifier(const FWeaponModifier& Modifier);
+
+	/** Removes every modifier named ModifierName; returns false if there was none */
+	UFUNCTION(BlueprintCallable, Category = "Weapon Properties")
+	bool RemoveModifier(FName ModifierName);
+
+	UFUNCTION(BlueprintCallable, Category = "Weapon Properties")
+	void ClearModifiers();
+
+	/** Replaces the modifier stack, e.g. from an inventory record, and rebuilds Stats once */
+	void SetModifiers(TArray<FWeaponModifier>&& NewModifiers);
+
+	FORCEINLINE const TArray<FWeaponModifier>& GetModifiers() const { return Modifiers; }
+
+	/** Crosshair textures from the shared definition, for the HUD */
+	UFUNCTION(BlueprintPure, Category = Crosshairs)
+	UTexture2D* GetCrosshairsMiddle() const;
+
+	UFUNCTION(BlueprintPure, Category = Crosshairs)
+	UTexture2D* GetCrosshairsLeft() const;
+
+	UFUNCTION(BlueprintPure, Category = Crosshairs)
+	UTexture2D* GetCrosshairsRight() const;
+
+	UFUNCTION(BlueprintPure, Category = Crosshairs)
+	UTexture2D* GetCrosshairsBottom() const;
+
+	UFUNCTION(BlueprintPure, Category = Crosshairs)
+	UTexture2D* GetCrosshairsTop() const;
 
 	void StartSlideTimer();
 
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponBehavior.h"
+#include "Weapon.h"
+
+namespace
+{
+	/** Fire policies */
+	struct FAutomaticFire
+	{
+		/** The definition decides; lets data turn a weapon semi-automatic */
+		static bool ShouldRefire(const AWeapon& Weapon) { return Weapon.GetAutomatic(); }
+	};
+
+	/** Reload policies */
+	struct FMagazineReload
+	{
+		/** Fills the magazine in one go */
+		static int32 GetReloadAmount(const AWeapon& Weapon, int32 CarriedAmmo)
+		{
+			const int32 MagEmptySpace{ Weapon.GetMagazineCapacity() - Weapon.GetAmmo() };
+			return FMath::Clamp(MagEmptySpace, 0, CarriedAmmo);
+		}
+	};
+
+	/** Cycling policies */
+	struct FNoCycling
+	{
+		static void OnFired(AWeapon& Weapon) {}
+	};
+
+	struct FSlideCycling
+	{
+		static void OnFired(AWeapon& Weapon) { Weapon.StartSlideTimer(); }
+	};
+
+	template<typename FirePolicy, typename ReloadPolicy, typename CyclingPolicy>
+	struct TWeaponBehavior
+	{
+		static constexpr FWeaponBehavior Table{
+			&CyclingPolicy::OnFired,
+			&FirePolicy::ShouldRefire,
+			&ReloadPolicy::GetReloadAmount };
+	};
+
+	template<typename FirePolicy, typename ReloadPolicy, typename CyclingPolicy>
+	constexpr FWeaponBehavior TWeaponBehavior<FirePolicy, ReloadPolicy, CyclingPolicy>::Table;
+
+	/** Policies for each weapon type; a new type adds a specialization and an entry in BehaviorsByType */
+	template<EWeaponType Type>
+	struct TWeaponTypeBehavior;
+
+	template<>
+	struct TWeaponTypeBehavior<EWeaponType::EWT_SubmachineGun> : TWeaponBehavior<FAutomaticFire, FMagazineReload, FNoCycling> {};
+
+	template<>
+	struct TWeaponTypeBehavior<EWeaponType::EWT_AssaultRifle> : TWeaponBehavior<FAutomaticFire, FMagazineReload, FNoCycling> {};
+
+	template<>
+	struct TWeaponTypeBehavior<EWeaponType::EWT_Pistol> : TWeaponBehavior<FAutomaticFire, FMagazineReload, FSlideCycling> {};
+
+	/** Indexed by EWeaponType */
+	const FWeaponBehavior* const BehaviorsByType[] =
+	{
+		&TWeaponTypeBehavior<EWeaponType::EWT_SubmachineGun>::Table,
+		&TWeaponTypeBehavior<EWeaponType::EWT_AssaultRifle>::Table,
+		&TWeaponTypeBehavior<EWeaponType::EWT_Pistol>::Table,
+	};
+
+	static_assert(UE_ARRAY_COUNT(BehaviorsByType) == (int32)EWeaponType::EWT_MAX, "Every EWeaponType needs a behaviour");
+}
+
+const FWeaponBehavior& FWeaponBehavior::Get(EWeaponType WeaponType)
+{
+	const int32 Index{ (int32)WeaponType };
+	return Index < UE_ARRAY_COUNT(BehaviorsByType) ? *BehaviorsByType[Index] : *BehaviorsByType[0];
+}
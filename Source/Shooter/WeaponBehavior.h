@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WeaponType.h"
+
+class AWeapon;
+
+/**
+ * Fire, reload and cycling behaviour of one weapon type as a table of plain
+ * function pointers. Each table is built at compile time from policy classes
+ * in WeaponBehavior.cpp and picked once when the Weapon's type is set, so the
+ * per-shot path makes no type checks.
+ */
+struct FWeaponBehavior
+{
+	/** After a shot has been fired, e.g. kicks the pistol slide back */
+	void (*OnFired)(AWeapon& Weapon);
+
+	/** True if holding the fire button keeps firing once the fire timer resets */
+	bool (*ShouldRefire)(const AWeapon& Weapon);
+
+	/** Rounds moved from CarriedAmmo into the magazine when a reload finishes */
+	int32 (*GetReloadAmount)(const AWeapon& Weapon, int32 CarriedAmmo);
+
+	/** Behaviour for WeaponType; never null */
+	static const FWeaponBehavior& Get(EWeaponType WeaponType);
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+#include "Weapon.h"
+#include "Sound/SoundCue.h"
+#include "Particles/ParticleSystem.h"
+
+const FPrimaryAssetType UWeaponDefinition::PrimaryAssetType(TEXT("WeaponDefinition"));
+const FName UWeaponDefinition::WorldBundle(TEXT("World"));
+const FName UWeaponDefinition::UIBundle(TEXT("UI"));
+
+UWeaponDefinition::UWeaponDefinition() :
+	WeaponType(EWeaponType::EWT_SubmachineGun),
+	AmmoType(EAmmoType::EAT_9mm),
+	WeaponAmmo(30),
+	MagazineCapacity(30),
+	MaterialIndex(0),
+	ClipBoneName(TEXT("smg_clip")),
+	ReloadMontageSection(FName(TEXT("Reload SMG"))),
+	AutoFireRate(0.1f),
+	bAutomatic(true),
+	Damage(0.f),
+	HeadShotDamage(0.f)
+{
+}
+
+FPrimaryAssetId UWeaponDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+UWeaponDefinition* UWeaponDefinition::CreateFromRow(UObject* Outer, EWeaponType Type, const FWeaponDataTable& Row)
+{
+	UWeaponDefinition* Definition = NewObject<UWeaponDefinition>(Outer, NAME_None, RF_Transient);
+	Definition->WeaponType = Type;
+	Definition->AmmoType = Row.AmmoType;
+	Definition->WeaponAmmo = Row.WeaponAmmo;
+	Definition->MagazineCapacity = Row.MagazingCapacity;
+	Definition->ItemName = Row.ItemName;
+	Definition->MaterialIndex = Row.MaterialIndex;
+	Definition->ClipBoneName = Row.ClipBoneName;
+	Definition->ReloadMontageSection = Row.ReloadMontageSection;
+	Definition->BoneToHide = Row.BoneToHide;
+	Definition->AutoFireRate = Row.AutoFireRate;
+	Definition->bAutomatic = Row.bAutomatic;
+	Definition->Damage = Row.Damage;
+	Definition->HeadShotDamage = Row.HeadShotDamage;
+
+	// The row already holds these loaded
+	Definition->ItemMesh = Row.ItemMesh;
+	Definition->MaterialInstance = Row.MaterialInstance;
+	Definition->AnimBP = Row.AnimBP.Get();
+	Definition->PickupSound = Row.PickupSound;
+	Definition->EquipSound = Row.EquipSound;
+	Definition->FireSound = Row.FireSound;
+	Definition->MuzzleFlash = Row.MuzzleFlash;
+	Definition->InventoryIcon = Row.InventoryIcon;
+	Definition->AmmoIcon = Row.AmmoIcon;
+	Definition->CrosshairsMiddle = Row.CrosshairsMiddle;
+	Definition->CrosshairsLeft = Row.CrosshairsLeft;
+	Definition->CrosshairsRight = Row.CrosshairsRight;
+	Definition->CrosshairsBottom = Row.CrosshairsBottom;
+	Definition->CrosshairsTop = Row.CrosshairsTop;
+
+	Definition->RowAssets = {
+		Row.ItemMesh, Row.MaterialInstance, Row.AnimBP.Get(), Row.PickupSound, Row.EquipSound, Row.FireSound, Row.MuzzleFlash,
+		Row.InventoryIcon, Row.AmmoIcon, Row.CrosshairsMiddle, Row.CrosshairsLeft, Row.CrosshairsRight, Row.CrosshairsBottom, Row.CrosshairsTop };
+	return Definition;
+}
+
+bool UWeaponDefinition::AreAssetsLoaded() const
+{
+	TArray<FSoftObjectPath> Paths;
+	GetAssetPaths(Paths);
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (Path.IsValid() && Path.ResolveObject() == nullptr)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UWeaponDefinition::LoadAssetsSynchronous() const
+{
+	TArray<FSoftObjectPath> Paths;
+	GetAssetPaths(Paths);
+	for (const FSoftObjectPath& Path : Paths)
+	{
+		if (Path.IsValid())
+		{
+			Path.TryLoad();
+		}
+	}
+}
+
+void UWeaponDefinition::GetAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Append({
+		ItemMesh.ToSoftObjectPath(), MaterialInstance.ToSoftObjectPath(), AnimBP.ToSoftObjectPath(),
+		PickupSound.ToSoftObjectPath(), EquipSound.ToSoftObjectPath(), FireSound.ToSoftObjectPath(), MuzzleFlash.ToSoftObjectPath(),
+		InventoryIcon.ToSoftObjectPath(), AmmoIcon.ToSoftObjectPath(),
+		CrosshairsMiddle.ToSoftObjectPath(), CrosshairsLeft.ToSoftObjectPath(), CrosshairsRight.ToSoftObjectPath(),
+		CrosshairsBottom.ToSoftObjectPath(), CrosshairsTop.ToSoftObjectPath() });
+}
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AmmoType.h"
+#include "WeaponType.h"
+#include "WeaponDefinition.generated.h"
+
+/**
+ * Definition of one weapon type. Gameplay values are loaded with the asset;
+ * meshes, sounds, effects and textures are soft references grouped into the
+ * "World" and "UI" asset bundles and streamed only when a weapon of this
+ * type becomes relevant.
+ */
+UCLASS(BlueprintType)
+class SHOOTER_API UWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponDefinition();
+
+	static const FPrimaryAssetType PrimaryAssetType;
+	static const FName WorldBundle;
+	static const FName UIBundle;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	/** Builds a transient definition from a Weapon data table row; used for types without a definition asset */
+	static UWeaponDefinition* CreateFromRow(UObject* Outer, EWeaponType Type, const struct FWeaponDataTable& Row);
+
+	/** True when every soft reference is either unset or loaded */
+	bool AreAssetsLoaded() const;
+
+	/** Loads every soft reference on the game thread; for editor construction scripts */
+	void LoadAssetsSynchronous() const;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	EWeaponType WeaponType;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	EAmmoType AmmoType;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	int32 WeaponAmmo;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	int32 MagazineCapacity;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	FString ItemName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	int32 MaterialIndex;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	FName ClipBoneName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	FName ReloadMontageSection;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	FName BoneToHide;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	float AutoFireRate;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	bool bAutomatic;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	float Damage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	float HeadShotDamage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<USkeletalMesh> ItemMesh;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<UMaterialInstance> MaterialInstance;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftClassPtr<UAnimInstance> AnimBP;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<class USoundCue> PickupSound;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<USoundCue> EquipSound;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<USoundCue> FireSound;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = World, meta = (AssetBundles = "World"))
+	TSoftObjectPtr<class UParticleSystem> MuzzleFlash;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> InventoryIcon;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> AmmoIcon;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> CrosshairsMiddle;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> CrosshairsLeft;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> CrosshairsRight;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> CrosshairsBottom;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = UI, meta = (AssetBundles = "UI"))
+	TSoftObjectPtr<UTexture2D> CrosshairsTop;
+
+private:
+	/** Every soft reference, for load checks */
+	void GetAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** Hard references kept by definitions built from a data table row */
+	UPROPERTY(Transient)
+	TArray<UObject*> RowAssets;
+};
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponModifier.h"
+#include "WeaponDefinition.h"
+#include "ShooterTuning.h"
+#include "Shooter.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon Stat Rebuilds"), STAT_WeaponStatRebuilds, STATGROUP_Shooter);
+
+namespace
+{
+	float GetBaseDamage(const UWeaponDefinition& Definition) { return Definition.Damage; }
+	float GetBaseHeadShotDamage(const UWeaponDefinition& Definition) { return Definition.HeadShotDamage; }
+	float GetBaseAutoFireRate(const UWeaponDefinition& Definition) { return Definition.AutoFireRate; }
+	float GetBaseMagazineCapacity(const UWeaponDefinition& Definition) { return (float)Definition.MagazineCapacity; }
+
+	float GetTunedDamage(const FWeaponTuning& Tuning) { return Tuning.Damage; }
+	float GetTunedHeadShotDamage(const FWeaponTuning& Tuning) { return Tuning.HeadShotDamage; }
+	float GetTunedAutoFireRate(const FWeaponTuning& Tuning) { return Tuning.AutoFireRate; }
+	float GetTunedMagazineCapacity(const FWeaponTuning& Tuning) { return (float)Tuning.MagazineCapacity; }
+
+	/** How one stat is read from the definition or the generated tables, and clamped after aggregation */
+	struct FWeaponStatDescriptor
+	{
+		EWeaponStat Stat;
+		float (*GetBaseValue)(const UWeaponDefinition&);
+		float (*GetTunedValue)(const FWeaponTuning&);
+		float MinValue;
+		bool bInteger;
+	};
+
+	/** One entry per EWeaponStat, in enum order */
+	constexpr FWeaponStatDescriptor StatDescriptors[] =
+	{
+		{ EWeaponStat::EWS_Damage, &GetBaseDamage, &GetTunedDamage, 0.f, false },
+		{ EWeaponStat::EWS_HeadShotDamage, &GetBaseHeadShotDamage, &GetTunedHeadShotDamage, 0.f, false },
+		// Seconds between automatic shots
+		{ EWeaponStat::EWS_AutoFireRate, &GetBaseAutoFireRate, &GetTunedAutoFireRate, 0.01f, false },
+		{ EWeaponStat::EWS_MagazineCapacity, &GetBaseMagazineCapacity, &GetTunedMagazineCapacity, 1.f, true },
+	};
+
+	static_assert(UE_ARRAY_COUNT(StatDescriptors) == FWeaponStatBlock::NumStats, "Every EWeaponStat needs a descriptor");
+}
+
+FWeaponStatBlock FWeaponStatBlock::Build(const UWeaponDefinition& Definition, const TArray<FWeaponModifier>& Modifiers)
+{
+	INC_DWORD_STAT(STAT_WeaponStatRebuilds);
+
+	float Added[NumStats] = {};
+	float Multiplier[NumStats];
+	for (float& Value : Multiplier)
+	{
+		Value = 1.f;
+	}
+
+	for (const FWeaponModifier& Modifier : Modifiers)
+	{
+		for (const FWeaponStatModifier& StatModifier : Modifier.StatModifiers)
+		{
+			const int32 Index{ (int32)StatModifier.Stat };
+			if (Index >= NumStats) continue;
+
+			if (StatModifier.Op == EWeaponModifierOp::EWMO_Multiply)
+			{
+				Multiplier[Index] *= StatModifier.Magnitude;
+			}
+			else
+			{
+				Added[Index] += StatModifier.Magnitude;
+			}
+		}
+	}
+
+	// Cooked builds read base values from the generated constexpr tables
+	const FWeaponTuning* Tuning{ ShooterTuning::FindWeapon(Definition.WeaponType) };
+
+	FWeaponStatBlock Block;
+	for (int32 Index = 0; Index < NumStats; ++Index)
+	{
+		const FWeaponStatDescriptor& Descriptor{ StatDescriptors[Index] };
+		checkSlow((int32)Descriptor.Stat == Index);
+
+		const float BaseValue{ Tuning ? Descriptor.GetTunedValue(*Tuning) : Descriptor.GetBaseValue(Definition) };
+		float Value{ (BaseValue + Added[Index]) * Multiplier[Index] };
+		if (Descriptor.bInteger)
+		{
+			Value = (float)FMath::RoundToInt(Value);
+		}
+		Block.Values[Index] = FMath::Max(Value, Descriptor.MinValue);
+	}
+	return Block;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WeaponModifier.generated.h"
+
+/** Modifiers one weapon can hold; inventory records keep one name per modifier */
+constexpr int32 MaxWeaponModifiers{ 8 };
+
+/** Weapon stats that modifiers can change; indexes FWeaponStatBlock::Values */
+UENUM(BlueprintType)
+enum class EWeaponStat : uint8
+{
+	EWS_Damage UMETA(DisplayName = "Damage"),
+	EWS_HeadShotDamage UMETA(DisplayName = "HeadShotDamage"),
+	EWS_AutoFireRate UMETA(DisplayName = "AutoFireRate"),
+	EWS_MagazineCapacity UMETA(DisplayName = "MagazineCapacity"),
+
+	EWS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+UENUM(BlueprintType)
+enum class EWeaponModifierOp : uint8
+{
+	/** Added to the base value */
+	EWMO_Add UMETA(DisplayName = "Add"),
+	/** Multiplies base plus additions; multipliers stack multiplicatively */
+	EWMO_Multiply UMETA(DisplayName = "Multiply"),
+
+	EWMO_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+USTRUCT(BlueprintType)
+struct FWeaponStatModifier
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EWeaponStat Stat = EWeaponStat::EWS_Damage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EWeaponModifierOp Op = EWeaponModifierOp::EWMO_Add;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Magnitude = 0.f;
+
+	FORCEINLINE bool operator==(const FWeaponStatModifier& Other) const
+	{
+		return Stat == Other.Stat && Op == Other.Op && Magnitude == Other.Magnitude;
+	}
+};
+
+/** An attachment or perk, e.g. extended mag or suppressor; may change several stats */
+USTRUCT(BlueprintType)
+struct FWeaponModifier
+{
+	GENERATED_BODY()
+
+	/** Identifies the modifier for removal and in inventory records */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName ModifierName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FWeaponStatModifier> StatModifiers;
+
+	FORCEINLINE bool operator==(const FWeaponModifier& Other) const
+	{
+		return ModifierName == Other.ModifierName && StatModifiers == Other.StatModifiers;
+	}
+};
+
+/**
+ * Final weapon stats after modifiers. Rebuilt only when the definition or the
+ * modifier stack changes; the fire path reads the cached values.
+ */
+struct FWeaponStatBlock
+{
+	static constexpr int32 NumStats{ (int32)EWeaponStat::EWS_MAX };
+
+	float Values[NumStats] = {};
+
+	FORCEINLINE float Get(EWeaponStat Stat) const { return Values[(int32)Stat]; }
+
+	/** Aggregates Modifiers on top of the base values of Definition */
+	static FWeaponStatBlock Build(const class UWeaponDefinition& Definition, const TArray<FWeaponModifier>& Modifiers);
+};